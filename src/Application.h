@@ -1,9 +1,21 @@
 #pragma once
 
 #include "Texture.h"
+#include "accumulation.h"
+#include "backgroundPolicy.h"
+#include "benchmark.h"
+#include "channelSampler.h"
+#include "checkerboard.h"
+#include "glState.h"
+#include "inputQueue.h"
+#include "latency.h"
 #include "programReport.h"
+#include "regionOfInterest.h"
+#include "textureUpload.h"
+#include "tiledRender.h"
 #include "watcher.h"
 #include <atomic>
+#include <string>
 
 struct Application {
     std::atomic<bool> running;
@@ -12,8 +24,25 @@ struct Application {
     int width = 1280;
     int height = 768;
     float pixelRatio = 0;
+    bool headless = false;     // no window, see headless.h
+    bool presentation = false; // no ImGui at all, for installations and measurements
+    int swapInterval = 1;      // -1 for adaptive vsync when the driver supports it
+    int monitor = 0;           // index of the monitor used by the fullscreen window
     bool pause = false;
     bool requestFrame = true;
     bool mouseButtonClicked[2] = {false, false};
+    float cursor[2] = {0.0f, 0.0f}; // last cursor position in window coordinates
+    InputQueue input;
+    Latency latency;
+    BackgroundPolicy background;
     ShaderCompileReport shaderReport;
+    Accumulation accumulation;
+    Benchmark benchmark;
+    TiledRender tiled;
+    Checkerboard checkerboard; // only used by the animated shaders drawn every frame
+    RegionOfInterest region;   // only shades the animated shaders in the region, magnifies every mode
+    GLStateStats glStats; // GL state calls of the last frame
+    TextureUploads textureUploads; // reloaded textures copied over several frames
+    ChannelSamplers samplers;      // filter and wrap of the channels, edited in the overlay
+    std::string textureCacheDirectory; // decoded images and their mipmaps, see textureCache.h, empty to disable
 };
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// texture read by an iChannel sampler, the texture unit is the index of the channel
+struct Channel {
+    GLuint texture = ~0x0u;
+    GLenum target = GL_TEXTURE_2D;
+    // storage of the texture, a reload needing the same one updates the texture in place
+    GLenum internalFormat = 0;
+    int size[3] = {0, 0, 0};
+    int levelCount = 0;
+};
@@ -1,19 +1,66 @@
 #pragma once
 
+#include "mappedFile.h"
+
 #include <stdint.h>
 #include <vector>
 
 struct Texture {
     enum Filter { LINEAR, LINEAR_MIPMAP_LINEAR, NEAREST };
     enum Wrap { REPEAT, CLAMP };
-    enum Format { RGBA, RGB, R };
+    enum Format { RGBA, RGB, RG, R };
     enum Target { TEXTURE_2D, TEXTURE_3D };
-    enum Type { UNSIGNED_BYTE, FLOAT };
+    enum Type { UNSIGNED_BYTE, UNSIGNED_SHORT, HALF_FLOAT, FLOAT };
+    enum Compression {
+        UNCOMPRESSED,
+        BC1,
+        BC2,
+        BC3,
+        BC4,
+        BC5,
+        BC6H_UNSIGNED,
+        BC6H_SIGNED,
+        BC7,
+        ETC2_RGB,
+        ETC2_RGB_A1,
+        ETC2_RGBA
+    };
+    // components read by the shader from a format reduced on load, see reduceTextureFormat
+    enum Swizzle {
+        NO_SWIZZLE,
+        GRAY,       // r is the gray level, read as (r, r, r, 1)
+        GRAY_ALPHA, // r is the gray level and g the alpha, read as (r, r, r, g)
+        OPAQUE_RG   // g was 1 everywhere, read as (r, 1, 0, 1)
+    };
+    struct Level {
+        const uint8_t* data;
+        size_t size;
+        int width;
+        int height;
+    };
     Type type = UNSIGNED_BYTE;
     Filter filter = LINEAR;
     Wrap wrap = REPEAT;
     Format format = RGBA;
+    Swizzle swizzle = NO_SWIZZLE;
+    bool fullPrecision = false; // float images are kept in 32 bits instead of being converted to half floats
+    int maxSize = 0;            // 2d images are downscaled on load so their largest side is at most maxSize, 0 for any
     std::vector<uint8_t> data;
+    MappedFile mapped; // raw 3d volumes and bc6h/bc7 textures are uploaded from the mapping of the file
+    Compression compression = UNCOMPRESSED;
+    std::vector<Level> levels; // mip levels of a compressed texture, in data once flipped or in the mapping
     int size[3] = {0, 0, 0};
-    Target target;
+    Target target = TEXTURE_2D;
 };
+
+inline size_t getTextureComponentSize(Texture::Type type)
+{
+    const size_t sizes[] = {1, 2, 2, 4};
+    return sizes[type];
+}
+
+inline size_t getTextureChannelCount(Texture::Format format)
+{
+    const size_t counts[] = {4, 3, 2, 1};
+    return counts[format];
+}
@@ -1,20 +1,45 @@
 #pragma once
 
+// built-in uniforms, the order is the one of the ShaderJoyInputs uniform block
+enum BuiltinUniform {
+    IMOUSE = 0, // NOLINT
+    IRESOLUTION,
+    ITIME,
+    ITIMEDELTA,
+    IFRAME,
+    IFRAMERATE,
+    ISAMPLECOUNT,
+    ICHANNELRESOLUTION,
+    BUILTIN_UNIFORM_COUNT
+};
+
 struct UniformList {
     float iResolution[3] = {};
     float iMouse[4] = {0.0f, 0.0f, 0.0f, 0.0f};
     float iTime = 0.0f;
     float iTimeDelta = 0.0f;
     int iFrame = 0;
-    int iChannel[4] = {0, 1, 2, 3};
+    int iSampleCount = 0;
+    float iFrameRate = 0.0f;
     float iChannelResolution[4][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
 
+    // locations are only used when the shader declares some built-in uniforms itself, otherwise the built-in
+    // uniforms are read from the ShaderJoyInputs uniform block
+    bool useUniformBlock = false;
     int iChannelResolutionLocation;
-    int iChannelLocation[4];
     int iMouseLocation;
     int iTimeLocation;
     int iResolutionLocation;
     int iTimeDeltaLocation;
     int iFrameLocation;
+    int iSampleCountLocation;
     int iFrameRateLocation;
+
+    // value of the shaderjoyCheckerboard uniform of the template, see checkerboard.h
+    int checkerboard = 0;
+    int checkerboardLocation = -1;
+
+    // inputs read by the shader, deduced from the active uniforms
+    bool usesTime = true;
+    bool usesMouse = true;
 };
@@ -0,0 +1,98 @@
+#include "accumulation.h"
+#include "glState.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+namespace {
+
+// average over all pixels of the standard error of the mean, sqrt(variance / n)
+float estimateNoise(const Accumulation& accumulation)
+{
+    const RenderTarget& target = accumulation.target;
+    const size_t valueCount = size_t(target.width) * size_t(target.height) * 3;
+    std::vector<float> mean(valueCount);
+    std::vector<float> moment(valueCount);
+
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(0, 0, target.width, target.height, GL_RGB, GL_FLOAT, mean.data());
+    glReadBuffer(GL_COLOR_ATTACHMENT1);
+    glReadPixels(0, 0, target.width, target.height, GL_RGB, GL_FLOAT, moment.data());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+    const double invSampleCount = 1.0 / double(accumulation.sampleCount);
+    double sum = 0.0;
+    for (size_t i = 0; i < valueCount; i++) {
+        const double variance = double(moment[i]) - double(mean[i]) * double(mean[i]);
+        if (variance > 0.0) {
+            sum += sqrt(variance * invSampleCount);
+        }
+    }
+    return float(sum / double(valueCount));
+}
+
+} // namespace
+
+bool setupAccumulation(Accumulation& accumulation, int width, int height)
+{
+    RenderTarget& target = accumulation.target;
+    if (target.framebuffer && target.width == width && target.height == height) {
+        return true;
+    }
+
+    destroyRenderTarget(target);
+    resetAccumulation(accumulation);
+    return createRenderTarget(target, width, height, GL_RGBA32F, 2);
+}
+
+void resetAccumulation(Accumulation& accumulation)
+{
+    accumulation.sampleCount = 0;
+    accumulation.noise = -1.0f;
+    accumulation.converged = false;
+}
+
+void beginAccumulationSample(const Accumulation& accumulation)
+{
+    bindFramebuffer(accumulation.target.framebuffer);
+
+    // running average: dst = src / (n + 1) + dst * n / (n + 1)
+    // the first sample uses a factor of 1 so the framebuffer does not need to be cleared on reset
+    setCapability(GL_BLEND, true);
+    glBlendColor(0.0f, 0.0f, 0.0f, 1.0f / float(accumulation.sampleCount + 1));
+    glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+}
+
+void endAccumulationSample(Accumulation& accumulation)
+{
+    setCapability(GL_BLEND, false);
+    accumulation.sampleCount++;
+
+    if (accumulation.maxSamples > 0 && accumulation.sampleCount >= accumulation.maxSamples) {
+        accumulation.converged = true;
+    }
+
+    if (accumulation.noiseThreshold > 0.0f && accumulation.sampleCount % accumulation.noiseCheckInterval == 0) {
+        accumulation.noise = estimateNoise(accumulation);
+        if (accumulation.noise <= accumulation.noiseThreshold) {
+            accumulation.converged = true;
+        }
+    }
+
+    if (accumulation.converged) {
+        printf("accumulation converged after %d samples", accumulation.sampleCount);
+        if (accumulation.noise >= 0.0f) {
+            printf(" (noise %f)", double(accumulation.noise));
+        }
+        printf("\n");
+    }
+
+    bindFramebuffer(0);
+}
+
+void cleanupAccumulation(Accumulation& accumulation)
+{
+    destroyRenderTarget(accumulation.target);
+    resetAccumulation(accumulation);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "renderTarget.h"
+
+// progressive accumulation: each frame is blended into a float framebuffer as a running average. The second
+// attachment keeps the running average of the squared color to estimate the remaining noise
+struct Accumulation {
+    bool enabled = false;
+    int maxSamples = 0;          // 0 means no limit
+    float noiseThreshold = 0.0f; // 0 means no noise check
+    int noiseCheckInterval = 32; // the noise estimation reads back the framebuffer so it's done every N samples
+
+    RenderTarget target;
+    int sampleCount = 0;
+    float noise = -1.0f; // -1 until the first estimation
+    bool converged = false;
+};
+
+// (re)create the framebuffer if needed, returns false if the framebuffer can't be created
+bool setupAccumulation(Accumulation& accumulation, int width, int height);
+void resetAccumulation(Accumulation& accumulation);
+void beginAccumulationSample(const Accumulation& accumulation);
+void endAccumulationSample(Accumulation& accumulation);
+void cleanupAccumulation(Accumulation& accumulation);
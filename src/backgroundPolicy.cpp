@@ -0,0 +1,64 @@
+#include "backgroundPolicy.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+const double ResumeDurationMS = 2000.0;
+} // namespace
+
+bool parseBackgroundPolicy(BackgroundPolicy& policy, const char* text)
+{
+    float value = 0.0f;
+    if (strcmp(text, "stop") == 0) {
+        policy.mode = BackgroundPolicy::STOP;
+    } else if (strcmp(text, "full") == 0) {
+        policy.mode = BackgroundPolicy::FULL;
+    } else if (sscanf(text, "fps:%f", &value) == 1 && value > 0.0f) {
+        policy.mode = BackgroundPolicy::FPS;
+        policy.fps = value;
+    } else if (sscanf(text, "scale:%f", &value) == 1 && value > 0.0f && value <= 1.0f) {
+        policy.mode = BackgroundPolicy::SCALE;
+        policy.resolutionScale = value;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool isWindowHidden(const BackgroundPolicy& policy, double now)
+{
+    if (now < policy.resumeUntil) {
+        return false;
+    }
+    return policy.iconified || (policy.throttleUnfocused && !policy.focused);
+}
+
+void resumeFullRate(BackgroundPolicy& policy, double now) { policy.resumeUntil = now + ResumeDurationMS; }
+
+double getBackgroundDelay(const BackgroundPolicy& policy, double now, double lastFrame)
+{
+    if (!isWindowHidden(policy, now)) {
+        return 0.0;
+    }
+    switch (policy.mode) {
+    case BackgroundPolicy::STOP:
+        return -1.0;
+    case BackgroundPolicy::FPS: {
+        const double remaining = lastFrame + 1000.0 / double(policy.fps) - now;
+        return remaining > 0.0 ? remaining : 0.0;
+    }
+    case BackgroundPolicy::FULL:
+    case BackgroundPolicy::SCALE:
+        break;
+    }
+    return 0.0;
+}
+
+float getBackgroundScale(const BackgroundPolicy& policy, double now)
+{
+    if (policy.mode != BackgroundPolicy::SCALE || !isWindowHidden(policy, now)) {
+        return 1.0f;
+    }
+    return policy.resolutionScale;
+}
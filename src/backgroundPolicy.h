@@ -0,0 +1,26 @@
+#pragma once
+
+// rendering while the window is hidden: iconified, or unfocused if throttleUnfocused is set. GLFW does not report
+// when the window is occluded by other windows, so the unfocused state is the closest signal. The focus or a file
+// reload resume the full rate immediately
+struct BackgroundPolicy {
+    enum Mode { FULL = 0, STOP, FPS, SCALE };
+    Mode mode = STOP;
+    float fps = 10.0f;             // FPS mode, frame rate cap
+    float resolutionScale = 0.25f; // SCALE mode, applied to both dimensions
+    bool throttleUnfocused = false;
+
+    bool focused = true;
+    bool iconified = false;
+    double resumeUntil = 0.0; // full rate after a reload, in ms
+};
+
+// parse a policy like "stop", "full", "fps:10" or "scale:0.25", returns false if the text is not valid
+bool parseBackgroundPolicy(BackgroundPolicy& policy, const char* text);
+bool isWindowHidden(const BackgroundPolicy& policy, double now);
+// keep the full rate for a while even if the window is hidden, used when a file is reloaded
+void resumeFullRate(BackgroundPolicy& policy, double now);
+// 0 to draw the frame now, the time to wait in ms before the next frame, or a negative value to wait for an event
+double getBackgroundDelay(const BackgroundPolicy& policy, double now, double lastFrame);
+// scale of the resolution, 1 if the frame is drawn at the full resolution
+float getBackgroundScale(const BackgroundPolicy& policy, double now);
@@ -0,0 +1,188 @@
+#include "benchmark.h"
+#include "glState.h"
+#include "renderTarget.h"
+#include "timer.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+namespace {
+
+// number of frames in flight, reading the oldest query result also throttles the driver queue
+const int QueryCount = 4;
+
+struct Statistics {
+    double min = 0.0;
+    double mean = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// nearest-rank percentile
+double percentile(const std::vector<double>& sorted, double p)
+{
+    size_t rank = size_t(ceil(p * double(sorted.size())));
+    rank = std::max(rank, size_t(1));
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+Statistics computeStatistics(const std::vector<double>& values)
+{
+    Statistics statistics;
+    if (values.empty()) {
+        return statistics;
+    }
+
+    std::vector<double> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (double value : sorted) {
+        sum += value;
+    }
+
+    statistics.min = sorted.front();
+    statistics.max = sorted.back();
+    statistics.mean = sum / double(sorted.size());
+    statistics.median = percentile(sorted, 0.5);
+    statistics.p95 = percentile(sorted, 0.95);
+    statistics.p99 = percentile(sorted, 0.99);
+    return statistics;
+}
+
+void writeStatistics(FILE* file, const char* name, const std::vector<double>& values)
+{
+    const Statistics s = computeStatistics(values);
+    fprintf(file,
+            "  \"%s\": {\"min\": %.4f, \"mean\": %.4f, \"median\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": "
+            "%.4f}",
+            name, s.min, s.mean, s.median, s.p95, s.p99, s.max);
+}
+
+void writeString(FILE* file, const char* name, const char* value)
+{
+    fprintf(file, "  \"%s\": \"", name);
+    for (const char* c = value; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*c, file);
+    }
+    fprintf(file, "\",\n");
+}
+
+} // namespace
+
+bool runBenchmark(Benchmark& benchmark, const DrawBenchmarkFrame& drawFrame)
+{
+    const int width = benchmark.width;
+    const int height = benchmark.height;
+    RenderTarget target;
+    if (!createRenderTarget(target, width, height, GL_RGBA8)) {
+        return false;
+    }
+    benchmark.cpuTimes.clear();
+    benchmark.gpuTimes.clear();
+
+    bindFramebuffer(target.framebuffer);
+    glViewport(0, 0, width, height);
+
+    GLuint queries[QueryCount];
+    glGenQueries(QueryCount, queries);
+
+    printf("benchmark %dx%d: warmup %.1f s\n", width, height, benchmark.warmupMS / 1000.0);
+
+    const double start = getTimeInMS();
+    double measureStart = 0.0;
+    double frameStart = start;
+    int firstMeasuredFrame = -1;
+    int frame = 0;
+    while (true) {
+        const double now = getTimeInMS();
+        if (firstMeasuredFrame != -1) {
+            benchmark.cpuTimes.push_back(now - frameStart);
+        }
+        frameStart = now;
+
+        if (firstMeasuredFrame == -1 && now - start >= benchmark.warmupMS) {
+            firstMeasuredFrame = frame;
+            measureStart = now;
+        }
+
+        if (firstMeasuredFrame != -1) {
+            const bool done = benchmark.frameCount > 0 ? frame - firstMeasuredFrame >= benchmark.frameCount
+                                                       : now - measureStart >= benchmark.durationMS;
+            if (done) {
+                break;
+            }
+        }
+
+        // the query is reused every QueryCount frames so we get the result of the frame it was used for
+        const GLuint query = queries[frame % QueryCount];
+        const int queryFrame = frame - QueryCount;
+        if (queryFrame >= 0) {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+            if (firstMeasuredFrame != -1 && queryFrame >= firstMeasuredFrame) {
+                benchmark.gpuTimes.push_back(double(elapsed) / 1.0e6);
+            }
+        }
+
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        drawFrame(frame);
+        glEndQuery(GL_TIME_ELAPSED);
+        glFlush();
+        frame++;
+    }
+
+    // results of the frames still in flight
+    for (int queryFrame = std::max(frame - QueryCount, 0); queryFrame < frame; queryFrame++) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries[queryFrame % QueryCount], GL_QUERY_RESULT, &elapsed);
+        if (queryFrame >= firstMeasuredFrame) {
+            benchmark.gpuTimes.push_back(double(elapsed) / 1.0e6);
+        }
+    }
+
+    glDeleteQueries(QueryCount, queries);
+    bindFramebuffer(0);
+    destroyRenderTarget(target);
+
+    printf("benchmark done: %zu frames measured\n", benchmark.cpuTimes.size());
+    return !benchmark.cpuTimes.empty();
+}
+
+bool writeBenchmarkReport(const Benchmark& benchmark, const char* shaderPath, uint64_t sourceHash)
+{
+    FILE* file = fopen(benchmark.outputPath, "wb");
+    if (!file) {
+        printf("cant open file %s\n", benchmark.outputPath);
+        return false;
+    }
+
+    char hash[32];
+    sprintf(hash, "%016llx", static_cast<unsigned long long>(sourceHash));
+
+    fprintf(file, "{\n");
+    writeString(file, "shader", shaderPath);
+    writeString(file, "source_hash", hash);
+    writeString(file, "renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    writeString(file, "vendor", reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    writeString(file, "gl_version", reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    fprintf(file, "  \"resolution\": [%d, %d],\n", benchmark.width, benchmark.height);
+    fprintf(file, "  \"warmup_ms\": %.1f,\n", benchmark.warmupMS);
+    fprintf(file, "  \"frames\": %zu,\n", benchmark.cpuTimes.size());
+    writeStatistics(file, "cpu_frame_ms", benchmark.cpuTimes);
+    fprintf(file, ",\n");
+    writeStatistics(file, "gpu_frame_ms", benchmark.gpuTimes);
+    fprintf(file, "\n}\n");
+    fclose(file);
+
+    printf("benchmark report written to %s\n", benchmark.outputPath);
+    return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+struct Benchmark {
+    bool enabled = false;
+    double warmupMS = 2000.0;
+    int frameCount = 0;      // number of frames measured, if 0 durationMS is used
+    double durationMS = 0.0; // measure duration when frameCount is 0
+    const char* outputPath = "./shaderjoy_benchmark.json";
+    int width = 0; // size of the offscreen framebuffer
+    int height = 0;
+
+    std::vector<double> cpuTimes; // wall clock between two frames in ms
+    std::vector<double> gpuTimes; // GL_TIME_ELAPSED of the draw in ms
+};
+
+// draw the frame with the given index in the current framebuffer
+using DrawBenchmarkFrame = std::function<void(int frame)>;
+
+// render offscreen at width x height: frames are drawn during the warmup then measured
+bool runBenchmark(Benchmark& benchmark, const DrawBenchmarkFrame& drawFrame);
+bool writeBenchmarkReport(const Benchmark& benchmark, const char* shaderPath, uint64_t sourceHash);
@@ -0,0 +1,48 @@
+#include "channelSampler.h"
+
+void initChannelSamplers(ChannelSamplers& samplers)
+{
+    const GLint minFilters[3] = {GL_LINEAR, GL_LINEAR_MIPMAP_LINEAR, GL_NEAREST};
+    const GLint magFilters[3] = {GL_LINEAR, GL_LINEAR, GL_NEAREST};
+    const GLint wraps[2] = {GL_REPEAT, GL_CLAMP_TO_EDGE};
+    for (int filter = 0; filter < 3; filter++) {
+        for (int wrap = 0; wrap < 2; wrap++) {
+            GLuint& sampler = samplers.objects[filter][wrap];
+            glGenSamplers(1, &sampler);
+            glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, minFilters[filter]);
+            glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, magFilters[filter]);
+            glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, wraps[wrap]);
+            glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, wraps[wrap]);
+            glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, wraps[wrap]);
+        }
+    }
+}
+
+int getChannelSource(const ChannelSamplers& samplers, int channel)
+{
+    const int source = samplers.channels[channel].source;
+    return source >= 0 ? source : channel;
+}
+
+GLuint getChannelSampler(const ChannelSamplers& samplers, int channel)
+{
+    const ChannelSampler& sampler = samplers.channels[channel];
+    return samplers.objects[sampler.filter][sampler.wrap];
+}
+
+void shareChannelResolutions(const ChannelSamplers& samplers, float (*resolutions)[3])
+{
+    for (int channel = 0; channel < 4; channel++) {
+        const int source = getChannelSource(samplers, channel);
+        for (int i = 0; i < 3; i++) {
+            resolutions[channel][i] = resolutions[source][i];
+        }
+    }
+}
+
+void cleanupChannelSamplers(ChannelSamplers& samplers)
+{
+    for (auto& filter : samplers.objects) {
+        glDeleteSamplers(2, filter);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <glad/glad.h>
+
+// the filter and the wrap of the channels are sampler objects, one for each combination, so they can be changed in the
+// overlay without touching the textures. A channel can sample the texture of another channel with its own settings,
+// the file is loaded once. Mipmap filtering reads only the first level of a texture loaded without mipmaps
+struct ChannelSampler {
+    bool enabled = false; // the channel has a texture, its own or the one of another channel
+    Texture::Filter filter = Texture::LINEAR;
+    Texture::Wrap wrap = Texture::REPEAT;
+    int source = -1; // channel whose texture is sampled, -1 for the texture of the channel
+};
+
+struct ChannelSamplers {
+    ChannelSampler channels[4];
+    GLuint objects[3][2]; // [filter][wrap]
+    bool changed = false; // a setting was edited, the frame must be drawn again
+};
+
+void initChannelSamplers(ChannelSamplers& samplers);
+// index of the channel whose texture is sampled by the channel
+int getChannelSource(const ChannelSamplers& samplers, int channel);
+GLuint getChannelSampler(const ChannelSamplers& samplers, int channel);
+// a channel sampling the texture of another one has the same resolution
+void shareChannelResolutions(const ChannelSamplers& samplers, float (*resolutions)[3]);
+void cleanupChannelSamplers(ChannelSamplers& samplers);
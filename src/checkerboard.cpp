@@ -0,0 +1,179 @@
+#include "checkerboard.h"
+#include "glState.h"
+
+namespace {
+
+enum Measure { FULL = 0, CHECKERBOARD };
+
+// a pixel is shaded by a phase if (x + y + phase) is even, the half target stores it at (x / 2, y)
+const char* const ReconstructFragment = R"(
+#version 330
+
+uniform sampler2D current;
+uniform sampler2D previous;
+uniform int phase;
+uniform bool hasPrevious;
+out vec4 frag_colour;
+
+vec4 fetchShaded(sampler2D image, ivec2 p, ivec2 size) {
+  p = clamp(p, ivec2(0), ivec2(size.x * 2 - 1, size.y - 1));
+  return texelFetch(image, ivec2(p.x / 2, p.y), 0);
+}
+
+void main() {
+  ivec2 p = ivec2(gl_FragCoord.xy);
+  ivec2 size = textureSize(current, 0);
+  if (((p.x + p.y + phase) & 1) == 0) {
+    frag_colour = fetchShaded(current, p, size);
+    return;
+  }
+
+  // the 4 neighbours are shaded this frame
+  vec4 left = fetchShaded(current, p - ivec2(1, 0), size);
+  vec4 right = fetchShaded(current, p + ivec2(1, 0), size);
+  vec4 down = fetchShaded(current, p - ivec2(0, 1), size);
+  vec4 up = fetchShaded(current, p + ivec2(0, 1), size);
+  if (!hasPrevious) {
+    frag_colour = (left + right + down + up) * 0.25;
+    return;
+  }
+  vec4 minimum = min(min(left, right), min(down, up));
+  vec4 maximum = max(max(left, right), max(down, up));
+  frag_colour = clamp(fetchShaded(previous, p, size), minimum, maximum);
+}
+)";
+
+void beginMeasure(Checkerboard& checkerboard, Measure measure)
+{
+    GLuint& query = checkerboard.queries[measure];
+    if (!query) {
+        glGenQueries(1, &query);
+    }
+    glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void endMeasure(Checkerboard& checkerboard, Measure measure)
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    checkerboard.queryPending[measure] = true;
+}
+
+// results are read when available to not stall the pipeline, returns false if the query is still in use
+bool collectMeasure(Checkerboard& checkerboard, Measure measure)
+{
+    if (!checkerboard.queryPending[measure]) {
+        return true;
+    }
+    GLuint available = 0;
+    glGetQueryObjectuiv(checkerboard.queries[measure], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return false;
+    }
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(checkerboard.queries[measure], GL_QUERY_RESULT, &elapsed);
+    checkerboard.queryPending[measure] = false;
+
+    float& average = measure == FULL ? checkerboard.fullMS : checkerboard.checkerboardMS;
+    const float ms = float(double(elapsed) / 1000000.0);
+    average = average == 0.0f ? ms : average * 0.9f + ms * 0.1f;
+    return true;
+}
+
+} // namespace
+
+bool setupCheckerboard(Checkerboard& checkerboard, int width, int height)
+{
+    if (!checkerboard.program) {
+        checkerboard.program = createFullscreenProgram(ReconstructFragment);
+        if (!checkerboard.program) {
+            return false;
+        }
+        checkerboard.currentLocation = glGetUniformLocation(checkerboard.program, "current");
+        checkerboard.previousLocation = glGetUniformLocation(checkerboard.program, "previous");
+        checkerboard.phaseLocation = glGetUniformLocation(checkerboard.program, "phase");
+        checkerboard.hasPreviousLocation = glGetUniformLocation(checkerboard.program, "hasPrevious");
+    }
+
+    const int halfWidth = (width + 1) / 2;
+    if (checkerboard.halves[0].framebuffer && checkerboard.halves[0].width == halfWidth &&
+        checkerboard.halves[0].height == height) {
+        return true;
+    }
+    for (RenderTarget& half : checkerboard.halves) {
+        destroyRenderTarget(half);
+        if (!createRenderTarget(half, halfWidth, height, GL_RGBA8)) {
+            return false;
+        }
+    }
+    checkerboard.historyFrame = -2;
+    return true;
+}
+
+void drawCheckerboardFrame(Checkerboard& checkerboard, int width, int height, const DrawCheckerboardFrame& draw)
+{
+    const bool measureFull = collectMeasure(checkerboard, FULL);
+    const bool measureCheckerboard = collectMeasure(checkerboard, CHECKERBOARD);
+
+    checkerboard.frame++;
+    if (checkerboard.frame % checkerboard.referenceInterval == 0 && measureFull) {
+        beginMeasure(checkerboard, FULL);
+        draw(0);
+        endMeasure(checkerboard, FULL);
+        return;
+    }
+
+    const bool hasPrevious = checkerboard.historyFrame == checkerboard.frame - 1;
+    checkerboard.phase = 1 - checkerboard.phase;
+    checkerboard.historyFrame = checkerboard.frame;
+    const RenderTarget& current = checkerboard.halves[checkerboard.phase];
+    const RenderTarget& previous = checkerboard.halves[1 - checkerboard.phase];
+
+    if (measureCheckerboard) {
+        beginMeasure(checkerboard, CHECKERBOARD);
+    }
+
+    bindFramebuffer(current.framebuffer);
+    glViewport(0, 0, current.width, current.height);
+    draw(1 + checkerboard.phase);
+    bindFramebuffer(0);
+    glViewport(0, 0, width, height);
+
+    useProgram(checkerboard.program);
+    bindTexture(0, GL_TEXTURE_2D, current.textures[0]);
+    bindTexture(1, GL_TEXTURE_2D, previous.textures[0]);
+    glUniform1i(checkerboard.currentLocation, 0);
+    glUniform1i(checkerboard.previousLocation, 1);
+    glUniform1i(checkerboard.phaseLocation, checkerboard.phase);
+    glUniform1i(checkerboard.hasPreviousLocation, hasPrevious);
+    drawFullscreenTriangle();
+
+    if (measureCheckerboard) {
+        endMeasure(checkerboard, CHECKERBOARD);
+    }
+}
+
+float getCheckerboardSpeedup(const Checkerboard& checkerboard)
+{
+    if (checkerboard.fullMS <= 0.0f || checkerboard.checkerboardMS <= 0.0f) {
+        return 0.0f;
+    }
+    return checkerboard.fullMS / checkerboard.checkerboardMS;
+}
+
+void cleanupCheckerboard(Checkerboard& checkerboard)
+{
+    for (RenderTarget& half : checkerboard.halves) {
+        destroyRenderTarget(half);
+    }
+    if (checkerboard.program) {
+        deleteProgram(checkerboard.program);
+    }
+    for (GLuint& query : checkerboard.queries) {
+        if (query) {
+            glDeleteQueries(1, &query);
+        }
+        query = 0;
+    }
+    checkerboard.program = 0;
+    checkerboard.queryPending[0] = checkerboard.queryPending[1] = false;
+}
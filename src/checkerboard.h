@@ -0,0 +1,40 @@
+#pragma once
+
+#include "renderTarget.h"
+
+#include <functional>
+
+// the shader is drawn on one pixel out of two in a checkerboard, alternating each frame, into a half width target.
+// The missing pixels come from the previous frame, clamped to the range of their 4 neighbours shaded this frame.
+// A full frame is drawn every referenceInterval frames to measure the speedup
+struct Checkerboard {
+    bool enabled = false;
+    int referenceInterval = 64;
+
+    RenderTarget halves[2]; // indexed by phase, the last two frames
+    int phase = 0;          // phase of the last half frame
+    int frame = 0;
+    int historyFrame = -2; // frame of the last half frame, the history is only used on the next frame
+    GLuint program = 0;
+    GLint currentLocation = -1;
+    GLint previousLocation = -1;
+    GLint phaseLocation = -1;
+    GLint hasPreviousLocation = -1;
+
+    // gpu time, averaged over the last frames
+    float fullMS = 0.0f;
+    float checkerboardMS = 0.0f; // shading of the half frame and reconstruction
+    GLuint queries[2] = {0, 0};  // full, checkerboard
+    bool queryPending[2] = {false, false};
+};
+
+// draw function given the value of the shaderjoyCheckerboard uniform: 0 for all the pixels, 1 + phase otherwise
+using DrawCheckerboardFrame = std::function<void(int checkerboard)>;
+
+// (re)create the targets if needed, returns false if they can't be created
+bool setupCheckerboard(Checkerboard& checkerboard, int width, int height);
+// draw the frame in the default framebuffer
+void drawCheckerboardFrame(Checkerboard& checkerboard, int width, int height, const DrawCheckerboardFrame& draw);
+// 0 until both the full and the checkerboard frames have been measured
+float getCheckerboardSpeedup(const Checkerboard& checkerboard);
+void cleanupCheckerboard(Checkerboard& checkerboard);
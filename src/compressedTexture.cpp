@@ -0,0 +1,786 @@
+#include "compressedTexture.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace {
+
+const GLenum GL_COMPRESSED_RGBA_S3TC_DXT1 = 0x83F1;
+const GLenum GL_COMPRESSED_RGBA_S3TC_DXT3 = 0x83F2;
+const GLenum GL_COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+
+struct CompressionInfo {
+    GLenum glFormat;
+    size_t blockSize; // bytes for 4x4 texels
+    Texture::Format format;
+    bool decodable; // a cpu decoder exists when the driver doesn't support the format
+    bool flippable; // the rows of the blocks can be reversed without decoding
+    const char* name;
+};
+
+// indexed by Texture::Compression
+const CompressionInfo Compressions[] = {
+    {0, 0, Texture::RGBA, false, false, "uncompressed"},
+    {GL_COMPRESSED_RGBA_S3TC_DXT1, 8, Texture::RGBA, true, true, "bc1"},
+    {GL_COMPRESSED_RGBA_S3TC_DXT3, 16, Texture::RGBA, true, true, "bc2"},
+    {GL_COMPRESSED_RGBA_S3TC_DXT5, 16, Texture::RGBA, true, true, "bc3"},
+    {GL_COMPRESSED_RED_RGTC1, 8, Texture::R, true, true, "bc4"},
+    {GL_COMPRESSED_RG_RGTC2, 16, Texture::RG, true, true, "bc5"},
+    {GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 16, Texture::RGB, false, false, "bc6h"},
+    {GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 16, Texture::RGB, false, false, "bc6h signed"},
+    {GL_COMPRESSED_RGBA_BPTC_UNORM, 16, Texture::RGBA, false, false, "bc7"},
+    {GL_COMPRESSED_RGB8_ETC2, 8, Texture::RGB, true, false, "etc2"},
+    {GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, 8, Texture::RGBA, true, false, "etc2 punchthrough alpha"},
+    {GL_COMPRESSED_RGBA8_ETC2_EAC, 16, Texture::RGBA, true, false, "etc2 eac"},
+};
+const int CompressionCount = sizeof(Compressions) / sizeof(Compressions[0]);
+
+// written once on the gl thread before the watcher thread starts
+bool Supported[CompressionCount] = {};
+
+// the containers identify the formats with their gl, vulkan or dxgi enums. srgb variants are sampled like the
+// decoded images, without conversion
+struct FormatMapping {
+    uint32_t value;
+    Texture::Compression compression;
+};
+
+const FormatMapping GLFormats[] = {
+    {0x83F0, Texture::BC1}, {0x83F1, Texture::BC1}, {0x8C4C, Texture::BC1}, {0x8C4D, Texture::BC1},
+    {0x83F2, Texture::BC2}, {0x8C4E, Texture::BC2}, {0x83F3, Texture::BC3}, {0x8C4F, Texture::BC3},
+    {0x8DBB, Texture::BC4}, {0x8DBD, Texture::BC5}, {0x8E8F, Texture::BC6H_UNSIGNED}, {0x8E8E, Texture::BC6H_SIGNED},
+    {0x8E8C, Texture::BC7}, {0x8E8D, Texture::BC7}, {0x9274, Texture::ETC2_RGB}, {0x9275, Texture::ETC2_RGB},
+    {0x9276, Texture::ETC2_RGB_A1}, {0x9277, Texture::ETC2_RGB_A1}, {0x9278, Texture::ETC2_RGBA},
+    {0x9279, Texture::ETC2_RGBA},
+};
+
+const FormatMapping VulkanFormats[] = {
+    {131, Texture::BC1}, {132, Texture::BC1}, {133, Texture::BC1}, {134, Texture::BC1}, {135, Texture::BC2},
+    {136, Texture::BC2}, {137, Texture::BC3}, {138, Texture::BC3}, {139, Texture::BC4}, {141, Texture::BC5},
+    {143, Texture::BC6H_UNSIGNED}, {144, Texture::BC6H_SIGNED}, {145, Texture::BC7}, {146, Texture::BC7},
+    {147, Texture::ETC2_RGB}, {148, Texture::ETC2_RGB}, {149, Texture::ETC2_RGB_A1}, {150, Texture::ETC2_RGB_A1},
+    {151, Texture::ETC2_RGBA}, {152, Texture::ETC2_RGBA},
+};
+
+const FormatMapping DXGIFormats[] = {
+    {71, Texture::BC1}, {72, Texture::BC1}, {74, Texture::BC2}, {75, Texture::BC2}, {77, Texture::BC3},
+    {78, Texture::BC3}, {80, Texture::BC4}, {83, Texture::BC5}, {95, Texture::BC6H_UNSIGNED},
+    {96, Texture::BC6H_SIGNED}, {98, Texture::BC7}, {99, Texture::BC7},
+};
+
+struct FourCCMapping {
+    char fourCC[5];
+    Texture::Compression compression;
+};
+
+const FourCCMapping FourCCFormats[] = {
+    {"DXT1", Texture::BC1}, {"DXT3", Texture::BC2}, {"DXT5", Texture::BC3}, {"ATI1", Texture::BC4},
+    {"BC4U", Texture::BC4}, {"ATI2", Texture::BC5}, {"BC5U", Texture::BC5},
+};
+
+const uint8_t KTXIdentifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+const uint8_t KTX2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+template <size_t N>
+Texture::Compression findCompression(const FormatMapping (&mappings)[N], uint32_t value)
+{
+    for (const FormatMapping& mapping : mappings) {
+        if (mapping.value == value) {
+            return mapping.compression;
+        }
+    }
+    return Texture::UNCOMPRESSED;
+}
+
+uint32_t readU32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint64_t readU64(const uint8_t* data)
+{
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+size_t getLevelSize(Texture::Compression compression, int width, int height)
+{
+    return size_t((width + 3) / 4) * size_t((height + 3) / 4) * Compressions[compression].blockSize;
+}
+
+int getLevelDimension(int size, size_t level)
+{
+    const int dimension = size >> level;
+    return dimension > 0 ? dimension : 1;
+}
+
+// 0 is read as a single level, more levels than the full mip chain is a corrupted file
+bool checkLevelCount(const Texture& texture, uint32_t& levelCount)
+{
+    if (texture.size[0] <= 0 || texture.size[1] <= 0) {
+        return false;
+    }
+    uint32_t maxLevelCount = 1;
+    for (int size = std::max(texture.size[0], texture.size[1]); size > 1; size /= 2) {
+        maxLevelCount++;
+    }
+    levelCount = levelCount ? levelCount : 1;
+    return levelCount <= maxLevelCount;
+}
+
+// the level must be entirely in the file, with the size expected from its dimensions
+bool addLevel(const MappedFile& file, Texture& texture, uint64_t offset, uint64_t size)
+{
+    const size_t level = texture.levels.size();
+    if (texture.size[0] <= 0 || texture.size[1] <= 0) {
+        return false;
+    }
+    const int width = getLevelDimension(texture.size[0], level);
+    const int height = getLevelDimension(texture.size[1], level);
+    if (size != getLevelSize(texture.compression, width, height) || offset > file.size || size > file.size - offset) {
+        return false;
+    }
+    texture.levels.push_back(Texture::Level{file.data + offset, size_t(size), width, height});
+    return true;
+}
+
+bool parseDDS(const MappedFile& file, Texture& texture)
+{
+    const size_t HeaderSize = 128;
+    const size_t DX10HeaderSize = 20;
+    const uint32_t MipMapCountFlag = 0x20000;
+    const uint32_t CubemapOrVolume = 0x200 | 0x200000;
+    if (file.size < HeaderSize || readU32(file.data + 4) != 124) {
+        return false;
+    }
+    const uint32_t flags = readU32(file.data + 8);
+    texture.size[1] = int(readU32(file.data + 12));
+    texture.size[0] = int(readU32(file.data + 16));
+    uint32_t levelCount = flags & MipMapCountFlag ? readU32(file.data + 28) : 1;
+    const uint8_t* fourCC = file.data + 84;
+    size_t offset = HeaderSize;
+    if (readU32(file.data + 112) & CubemapOrVolume) {
+        return false;
+    }
+
+    if (memcmp(fourCC, "DX10", 4) == 0) {
+        // dxgi format, dimension, flags, array size
+        if (file.size < HeaderSize + DX10HeaderSize || readU32(file.data + HeaderSize + 12) > 1) {
+            return false;
+        }
+        texture.compression = findCompression(DXGIFormats, readU32(file.data + HeaderSize));
+        offset += DX10HeaderSize;
+    } else {
+        for (const FourCCMapping& mapping : FourCCFormats) {
+            if (memcmp(fourCC, mapping.fourCC, 4) == 0) {
+                texture.compression = mapping.compression;
+            }
+        }
+    }
+    if (texture.compression == Texture::UNCOMPRESSED || !checkLevelCount(texture, levelCount)) {
+        return false;
+    }
+
+    // the levels follow each other, from the largest
+    for (uint32_t level = 0; level < levelCount; level++) {
+        const int width = getLevelDimension(texture.size[0], level);
+        const int height = getLevelDimension(texture.size[1], level);
+        const size_t size = getLevelSize(texture.compression, width, height);
+        if (!addLevel(file, texture, offset, size)) {
+            return false;
+        }
+        offset += size;
+    }
+    return true;
+}
+
+bool parseKTX(const MappedFile& file, Texture& texture)
+{
+    const size_t HeaderSize = 64;
+    // the writer endianness must match, the fields would have to be swapped otherwise
+    if (file.size < HeaderSize || readU32(file.data + 12) != 0x04030201) {
+        return false;
+    }
+    const uint32_t glType = readU32(file.data + 16);
+    texture.compression = findCompression(GLFormats, readU32(file.data + 28));
+    texture.size[0] = int(readU32(file.data + 36));
+    texture.size[1] = int(readU32(file.data + 40));
+    const uint32_t depth = readU32(file.data + 44);
+    const uint32_t arrayElements = readU32(file.data + 48);
+    const uint32_t faces = readU32(file.data + 52);
+    uint32_t levelCount = readU32(file.data + 56);
+    const uint32_t keyValueSize = readU32(file.data + 60);
+    if (glType != 0 || texture.compression == Texture::UNCOMPRESSED || depth > 1 || arrayElements > 0 || faces != 1 ||
+        !checkLevelCount(texture, levelCount)) {
+        return false;
+    }
+
+    // each level is preceded by its size, and padded to 4 bytes
+    uint64_t offset = HeaderSize + uint64_t(keyValueSize);
+    for (uint32_t level = 0; level < levelCount; level++) {
+        if (offset + 4 > file.size) {
+            return false;
+        }
+        const uint32_t size = readU32(file.data + offset);
+        if (!addLevel(file, texture, offset + 4, size)) {
+            return false;
+        }
+        offset += 4 + ((uint64_t(size) + 3) & ~uint64_t(3));
+    }
+    return true;
+}
+
+bool parseKTX2(const MappedFile& file, Texture& texture)
+{
+    const size_t LevelIndexOffset = 80;
+    if (file.size < LevelIndexOffset) {
+        return false;
+    }
+    texture.compression = findCompression(VulkanFormats, readU32(file.data + 12));
+    texture.size[0] = int(readU32(file.data + 20));
+    texture.size[1] = int(readU32(file.data + 24));
+    const uint32_t depth = readU32(file.data + 28);
+    const uint32_t layers = readU32(file.data + 32);
+    const uint32_t faces = readU32(file.data + 36);
+    uint32_t levelCount = readU32(file.data + 40);
+    const uint32_t supercompression = readU32(file.data + 44);
+    // basis universal and zstd supercompressed files would need a transcoder
+    if (texture.compression == Texture::UNCOMPRESSED || depth > 1 || layers > 1 || faces != 1 ||
+        supercompression != 0 || !checkLevelCount(texture, levelCount)) {
+        return false;
+    }
+
+    // offset, size and uncompressed size of each level, from the largest
+    for (uint32_t level = 0; level < levelCount; level++) {
+        const size_t index = LevelIndexOffset + size_t(level) * 24;
+        if (index + 24 > file.size) {
+            return false;
+        }
+        if (!addLevel(file, texture, readU64(file.data + index), readU64(file.data + index + 8))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void writeColor(uint8_t* rgba, int r, int g, int b, int a)
+{
+    rgba[0] = uint8_t(r < 0 ? 0 : r > 255 ? 255 : r);
+    rgba[1] = uint8_t(g < 0 ? 0 : g > 255 ? 255 : g);
+    rgba[2] = uint8_t(b < 0 ? 0 : b > 255 ? 255 : b);
+    rgba[3] = uint8_t(a);
+}
+
+// texels are stored row by row in rgba, 4x4 texels
+void decodeBC1Block(const uint8_t* block, uint8_t* rgba, bool allowTransparent)
+{
+    const int color0 = block[0] | block[1] << 8;
+    const int color1 = block[2] | block[3] << 8;
+    int colors[4][4];
+    for (int i = 0; i < 2; i++) {
+        const int color = i ? color1 : color0;
+        const int r = (color >> 11) & 31;
+        const int g = (color >> 5) & 63;
+        const int b = color & 31;
+        colors[i][0] = r << 3 | r >> 2;
+        colors[i][1] = g << 2 | g >> 4;
+        colors[i][2] = b << 3 | b >> 2;
+        colors[i][3] = 255;
+    }
+    for (int c = 0; c < 3; c++) {
+        if (color0 > color1 || !allowTransparent) {
+            colors[2][c] = (2 * colors[0][c] + colors[1][c]) / 3;
+            colors[3][c] = (colors[0][c] + 2 * colors[1][c]) / 3;
+        } else {
+            colors[2][c] = (colors[0][c] + colors[1][c]) / 2;
+            colors[3][c] = 0;
+        }
+    }
+    colors[2][3] = 255;
+    colors[3][3] = color0 > color1 || !allowTransparent ? 255 : 0;
+
+    const uint32_t indices = readU32(block + 4);
+    for (int i = 0; i < 16; i++) {
+        const int* color = colors[(indices >> (2 * i)) & 3];
+        writeColor(rgba + i * 4, color[0], color[1], color[2], color[3]);
+    }
+}
+
+void decodeBC2Alpha(const uint8_t* block, uint8_t* rgba)
+{
+    for (int i = 0; i < 16; i++) {
+        const int alpha = (block[i / 2] >> (4 * (i & 1))) & 15;
+        rgba[i * 4 + 3] = uint8_t(alpha * 17);
+    }
+}
+
+// the alpha of bc3 blocks, also the red and green of bc4 and bc5 blocks
+void decodeBC4Block(const uint8_t* block, uint8_t* rgba, int channel)
+{
+    int alphas[8] = {block[0], block[1]};
+    for (int i = 1; i < 7; i++) {
+        if (alphas[0] > alphas[1]) {
+            alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1]) / 7;
+        } else if (i < 5) {
+            alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1]) / 5;
+        }
+    }
+    if (alphas[0] <= alphas[1]) {
+        alphas[6] = 0;
+        alphas[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++) {
+        indices |= uint64_t(block[2 + i]) << (8 * i);
+    }
+    for (int i = 0; i < 16; i++) {
+        rgba[i * 4 + channel] = uint8_t(alphas[(indices >> (3 * i)) & 7]);
+    }
+}
+
+const int ETC1Modifiers[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+const int ETC2Distances[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+int extend4(int value)
+{
+    return value << 4 | value;
+}
+
+int extend5(int value)
+{
+    return value << 3 | value >> 2;
+}
+
+int extend6(int value)
+{
+    return value << 2 | value >> 4;
+}
+
+int extend7(int value)
+{
+    return value << 1 | value >> 6;
+}
+
+// the texels of etc blocks are stored column by column, the 2 bits index of texel i is split between bit i and bit
+// i + 16. The diff bit becomes the opaque bit for the punchthrough alpha format
+void decodeETC2Block(const uint8_t* block, uint8_t* rgba, bool punchthrough)
+{
+    const uint32_t indices = uint32_t(block[4]) << 24 | uint32_t(block[5]) << 16 | uint32_t(block[6]) << 8 | block[7];
+    const bool differential = punchthrough || (block[3] & 2);
+    const bool opaque = !punchthrough || (block[3] & 2);
+    auto getIndex = [indices](int x, int y) {
+        const int i = x * 4 + y;
+        return int((indices >> (i + 15)) & 2) | int((indices >> i) & 1);
+    };
+    // T, H and planar modes are encoded as a differential block whose base color overflows
+    const int r = block[0] >> 3;
+    const int g = block[1] >> 3;
+    const int b = block[2] >> 3;
+    // 3 bits two's complement deltas
+    const int dr = (block[0] & 7) - ((block[0] & 4) << 1);
+    const int dg = (block[1] & 7) - ((block[1] & 4) << 1);
+    const int db = (block[2] & 7) - ((block[2] & 4) << 1);
+
+    if (differential && (r + dr < 0 || r + dr > 31 || g + dg < 0 || g + dg > 31)) {
+        int base[2][3];
+        int distance;
+        int paint[4][3];
+        if (r + dr < 0 || r + dr > 31) {
+            // T mode
+            base[0][0] = extend4((block[0] >> 1 & 0xc) | (block[0] & 3));
+            base[0][1] = extend4(block[1] >> 4);
+            base[0][2] = extend4(block[1] & 15);
+            base[1][0] = extend4(block[2] >> 4);
+            base[1][1] = extend4(block[2] & 15);
+            base[1][2] = extend4(block[3] >> 4);
+            distance = ETC2Distances[(block[3] >> 1 & 6) | (block[3] & 1)];
+            for (int c = 0; c < 3; c++) {
+                paint[0][c] = base[0][c];
+                paint[1][c] = base[1][c] + distance;
+                paint[2][c] = base[1][c];
+                paint[3][c] = base[1][c] - distance;
+            }
+        } else {
+            // H mode, the order of the base colors gives the lowest bit of the distance
+            base[0][0] = extend4(block[0] >> 3 & 15);
+            base[0][1] = extend4((block[0] & 7) << 1 | (block[1] >> 4 & 1));
+            base[0][2] = extend4((block[1] & 8) | (block[1] & 3) << 1 | block[2] >> 7);
+            base[1][0] = extend4(block[2] >> 3 & 15);
+            base[1][1] = extend4((block[2] & 7) << 1 | block[3] >> 7);
+            base[1][2] = extend4(block[3] >> 3 & 15);
+            const int value0 = base[0][0] << 16 | base[0][1] << 8 | base[0][2];
+            const int value1 = base[1][0] << 16 | base[1][1] << 8 | base[1][2];
+            distance = ETC2Distances[(block[3] & 4) | (block[3] & 1) << 1 | (value0 >= value1 ? 1 : 0)];
+            for (int c = 0; c < 3; c++) {
+                paint[0][c] = base[0][c] + distance;
+                paint[1][c] = base[0][c] - distance;
+                paint[2][c] = base[1][c] + distance;
+                paint[3][c] = base[1][c] - distance;
+            }
+        }
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                const int index = getIndex(x, y);
+                uint8_t* texel = rgba + (y * 4 + x) * 4;
+                if (!opaque && index == 2) {
+                    writeColor(texel, 0, 0, 0, 0);
+                } else {
+                    writeColor(texel, paint[index][0], paint[index][1], paint[index][2], 255);
+                }
+            }
+        }
+        return;
+    }
+
+    if (differential && (b + db < 0 || b + db > 31)) {
+        // planar mode, the origin, horizontal and vertical colors are interpolated, it's always opaque
+        const int origin[3] = {extend6(block[0] >> 1 & 63), extend7((block[0] & 1) << 6 | (block[1] >> 1 & 63)),
+                               extend6((block[1] & 1) << 5 | (block[2] & 0x18) | (block[2] & 3) << 1 | block[3] >> 7)};
+        const int horizontal[3] = {extend6((block[3] & 0x7c) >> 1 | (block[3] & 1)), extend7(block[4] >> 1 & 127),
+                                   extend6((block[4] & 1) << 5 | (block[5] >> 3 & 31))};
+        const int vertical[3] = {extend6((block[5] & 7) << 3 | (block[6] >> 5 & 7)),
+                                 extend7((block[6] & 31) << 2 | (block[7] >> 6 & 3)), extend6(block[7] & 63)};
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                int color[3];
+                for (int c = 0; c < 3; c++) {
+                    color[c] =
+                        (x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+                }
+                writeColor(rgba + (y * 4 + x) * 4, color[0], color[1], color[2], 255);
+            }
+        }
+        return;
+    }
+
+    // etc1 compatible modes, two sub blocks of 2x4 texels, or 4x2 if the flip bit is set
+    int base[2][3];
+    if (differential) {
+        base[0][0] = extend5(r);
+        base[0][1] = extend5(g);
+        base[0][2] = extend5(b);
+        base[1][0] = extend5(r + dr);
+        base[1][1] = extend5(g + dg);
+        base[1][2] = extend5(b + db);
+    } else {
+        for (int c = 0; c < 3; c++) {
+            base[0][c] = extend4(block[c] >> 4);
+            base[1][c] = extend4(block[c] & 15);
+        }
+    }
+    const int tables[2] = {block[3] >> 5, block[3] >> 2 & 7};
+    const bool flip = block[3] & 1;
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            const int subBlock = flip ? y / 2 : x / 2;
+            const int index = getIndex(x, y);
+            const int* modifiers = ETC1Modifiers[tables[subBlock]];
+            int modifier = index & 1 ? modifiers[1] : modifiers[0];
+            modifier = index & 2 ? -modifier : modifier;
+            uint8_t* texel = rgba + (y * 4 + x) * 4;
+            if (!opaque && index == 2) {
+                writeColor(texel, 0, 0, 0, 0);
+                continue;
+            }
+            // without the opaque bit the smallest modifiers are 0
+            modifier = !opaque && !(index & 1) ? 0 : modifier;
+            writeColor(texel, base[subBlock][0] + modifier, base[subBlock][1] + modifier, base[subBlock][2] + modifier,
+                       255);
+        }
+    }
+}
+
+const int EACModifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12}, {-3, -6, -8, -12, 2, 5, 7, 11},  {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},  {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},  {-2, -4, -8, -10, 1, 3, 7, 9},   {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},   {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8},
+};
+
+// 3 bits indices from the most significant bit, texels column by column
+void decodeEACAlpha(const uint8_t* block, uint8_t* rgba)
+{
+    const int base = block[0];
+    const int multiplier = block[1] >> 4;
+    const int* modifiers = EACModifiers[block[1] & 15];
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++) {
+        indices = indices << 8 | block[2 + i];
+    }
+    for (int i = 0; i < 16; i++) {
+        const int alpha = base + modifiers[(indices >> (45 - 3 * i)) & 7] * multiplier;
+        const int x = i / 4;
+        const int y = i % 4;
+        rgba[(y * 4 + x) * 4 + 3] = uint8_t(alpha < 0 ? 0 : alpha > 255 ? 255 : alpha);
+    }
+}
+
+void decodeBlock(Texture::Compression compression, const uint8_t* block, uint8_t* rgba)
+{
+    switch (compression) {
+    case Texture::BC1:
+        decodeBC1Block(block, rgba, true);
+        break;
+    case Texture::BC2:
+        decodeBC1Block(block + 8, rgba, false);
+        decodeBC2Alpha(block, rgba);
+        break;
+    case Texture::BC3:
+        decodeBC1Block(block + 8, rgba, false);
+        decodeBC4Block(block, rgba, 3);
+        break;
+    case Texture::BC4:
+    case Texture::BC5:
+        // read like the r and rg textures, (r, 0, 0, 1) and (r, g, 0, 1)
+        for (int i = 0; i < 16; i++) {
+            writeColor(rgba + i * 4, 0, 0, 0, 255);
+        }
+        decodeBC4Block(block, rgba, 0);
+        if (compression == Texture::BC5) {
+            decodeBC4Block(block + 8, rgba, 1);
+        }
+        break;
+    case Texture::ETC2_RGB:
+        decodeETC2Block(block, rgba, false);
+        break;
+    case Texture::ETC2_RGB_A1:
+        decodeETC2Block(block, rgba, true);
+        break;
+    case Texture::ETC2_RGBA:
+        decodeETC2Block(block + 8, rgba, false);
+        decodeEACAlpha(block, rgba);
+        break;
+    default:
+        break;
+    }
+}
+
+// only the first level is decoded, the mipmaps are generated like for the other images. The rows are flipped like
+// the other images, see textureFile.cpp
+void decodeTexture(Texture& texture)
+{
+    const Texture::Level& level = texture.levels[0];
+    const size_t blockSize = Compressions[texture.compression].blockSize;
+    const int columns = (level.width + 3) / 4;
+    const int rows = (level.height + 3) / 4;
+    texture.data.resize(size_t(level.width) * size_t(level.height) * 4);
+    uint8_t rgba[16 * 4];
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            decodeBlock(texture.compression, level.data + (size_t(row) * size_t(columns) + size_t(column)) * blockSize,
+                        rgba);
+            // blocks on the right and top edges are clipped
+            const int width = level.width - column * 4 < 4 ? level.width - column * 4 : 4;
+            const int height = level.height - row * 4 < 4 ? level.height - row * 4 : 4;
+            for (int y = 0; y < height; y++) {
+                const int flippedY = level.height - 1 - (row * 4 + y);
+                const size_t offset = (size_t(flippedY) * size_t(level.width) + size_t(column * 4)) * 4;
+                memcpy(texture.data.data() + offset, rgba + y * 16, size_t(width) * 4);
+            }
+        }
+    }
+    texture.format = Texture::RGBA;
+    texture.type = Texture::UNSIGNED_BYTE;
+    texture.compression = Texture::UNCOMPRESSED;
+    texture.levels.clear();
+}
+
+// 2 bits indices, one byte per row
+void flipBC1Indices(uint8_t* indices, int rowCount)
+{
+    std::reverse(indices, indices + rowCount);
+}
+
+// 4 bits alphas, two bytes per row
+void flipBC2Alpha(uint8_t* alphas, int rowCount)
+{
+    for (int y = 0; y < rowCount / 2; y++) {
+        std::swap_ranges(alphas + y * 2, alphas + y * 2 + 2, alphas + (rowCount - 1 - y) * 2);
+    }
+}
+
+// 3 bits indices after the two endpoints, 12 bits per row
+void flipBC4Indices(uint8_t* block, int rowCount)
+{
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++) {
+        indices |= uint64_t(block[2 + i]) << (8 * i);
+    }
+    uint64_t flipped = indices & ~((uint64_t(1) << (12 * rowCount)) - 1);
+    for (int y = 0; y < rowCount; y++) {
+        flipped |= ((indices >> (12 * y)) & 0xfff) << (12 * (rowCount - 1 - y));
+    }
+    for (int i = 0; i < 6; i++) {
+        block[2 + i] = uint8_t(flipped >> (8 * i));
+    }
+}
+
+// the first rowCount rows of texels are reversed, the others are outside of the level
+void flipBlock(Texture::Compression compression, uint8_t* block, int rowCount)
+{
+    switch (compression) {
+    case Texture::BC1:
+        flipBC1Indices(block + 4, rowCount);
+        break;
+    case Texture::BC2:
+        flipBC2Alpha(block, rowCount);
+        flipBC1Indices(block + 12, rowCount);
+        break;
+    case Texture::BC3:
+        flipBC4Indices(block, rowCount);
+        flipBC1Indices(block + 12, rowCount);
+        break;
+    case Texture::BC4:
+        flipBC4Indices(block, rowCount);
+        break;
+    case Texture::BC5:
+        flipBC4Indices(block, rowCount);
+        flipBC4Indices(block + 8, rowCount);
+        break;
+    default:
+        break;
+    }
+}
+
+// a level is flipped exactly when its rows fill its blocks, or fit in one row of blocks
+bool canFlipLevel(const Texture::Level& level)
+{
+    return level.height <= 4 || level.height % 4 == 0;
+}
+
+// the rows of blocks are reversed and the rows of texels in each block. The levels are copied in texture.data, the
+// levels after one that can't be flipped are dropped
+void flipLevels(Texture& texture)
+{
+    const size_t blockSize = Compressions[texture.compression].blockSize;
+    size_t levelCount = 0;
+    size_t total = 0;
+    while (levelCount < texture.levels.size() && canFlipLevel(texture.levels[levelCount])) {
+        total += texture.levels[levelCount].size;
+        levelCount++;
+    }
+    texture.levels.resize(levelCount);
+    texture.data.resize(total);
+
+    uint8_t* data = texture.data.data();
+    for (Texture::Level& level : texture.levels) {
+        const size_t rowSize = size_t((level.width + 3) / 4) * blockSize;
+        const int rows = (level.height + 3) / 4;
+        const int rowCount = std::min(level.height, 4);
+        for (int row = 0; row < rows; row++) {
+            uint8_t* flipped = data + size_t(rows - 1 - row) * rowSize;
+            memcpy(flipped, level.data + size_t(row) * rowSize, rowSize);
+            for (size_t offset = 0; offset < rowSize; offset += blockSize) {
+                flipBlock(texture.compression, flipped + offset, rowCount);
+            }
+        }
+        level.data = data;
+        data += level.size;
+    }
+}
+
+} // namespace
+
+void initCompressedTextureSupport()
+{
+    bool s3tc = false;
+    bool bptc = GLAD_GL_VERSION_4_2;
+    bool etc2 = GLAD_GL_VERSION_4_3;
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, GLuint(i)));
+        s3tc = s3tc || strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0;
+        bptc = bptc || strcmp(extension, "GL_ARB_texture_compression_bptc") == 0;
+        etc2 = etc2 || strcmp(extension, "GL_ARB_ES3_compatibility") == 0;
+    }
+
+    Supported[Texture::BC1] = Supported[Texture::BC2] = Supported[Texture::BC3] = s3tc;
+    Supported[Texture::BC4] = Supported[Texture::BC5] = true; // core since gl 3.0
+    Supported[Texture::BC6H_UNSIGNED] = Supported[Texture::BC6H_SIGNED] = Supported[Texture::BC7] = bptc;
+    Supported[Texture::ETC2_RGB] = Supported[Texture::ETC2_RGB_A1] = Supported[Texture::ETC2_RGBA] = etc2;
+}
+
+bool isCompressedTextureFile(const uint8_t* header, size_t size)
+{
+    return size >= 12 && (memcmp(header, "DDS ", 4) == 0 || memcmp(header, KTXIdentifier, 12) == 0 ||
+                          memcmp(header, KTX2Identifier, 12) == 0);
+}
+
+bool readCompressedTexture(const char* path, Texture& texture)
+{
+    unmapFile(texture.mapped);
+    texture.data.clear();
+    texture.levels.clear();
+    texture.compression = Texture::UNCOMPRESSED;
+    if (!mapFile(path, texture.mapped)) {
+        printf("cant map file %s\n", path);
+        return false;
+    }
+
+    const MappedFile& file = texture.mapped;
+    bool success;
+    if (memcmp(file.data, "DDS ", 4) == 0) {
+        success = parseDDS(file, texture);
+    } else if (memcmp(file.data, KTXIdentifier, 12) == 0) {
+        success = parseKTX(file, texture);
+    } else {
+        success = parseKTX2(file, texture);
+    }
+    if (!success || texture.size[0] <= 0 || texture.size[1] <= 0) {
+        printf("cant read compressed texture %s: truncated file or not a 2d texture of bc1 to bc7 or etc2 blocks\n",
+               path);
+        unmapFile(texture.mapped);
+        texture.levels.clear();
+        texture.compression = Texture::UNCOMPRESSED;
+        return false;
+    }
+
+    // the blocks that can't be flipped are decoded to be flipped like the other images
+    const CompressionInfo& info = Compressions[texture.compression];
+    const bool supported = Supported[texture.compression];
+    const bool flippable = info.flippable && canFlipLevel(texture.levels[0]);
+    const size_t fileSize = file.size;
+    if (!supported || (!flippable && info.decodable)) {
+        if (!info.decodable) {
+            printf("compressed texture %s: %s is not supported by the driver\n", path, info.name);
+            unmapFile(texture.mapped);
+            texture.levels.clear();
+            texture.compression = Texture::UNCOMPRESSED;
+            return false;
+        }
+        decodeTexture(texture);
+        unmapFile(texture.mapped);
+        printf("read compressed texture %s %dx%d : %s decoded on the cpu, %s\n", path, texture.size[0],
+               texture.size[1], info.name,
+               supported ? "its blocks can't be flipped" : "not supported by the driver");
+        return true;
+    }
+
+    if (flippable) {
+        flipLevels(texture);
+        unmapFile(texture.mapped);
+    } else {
+        printf("compressed texture %s: %s blocks can't be flipped, the image is upside down compared to the other "
+               "formats\n",
+               path, info.name);
+    }
+    texture.format = info.format;
+    texture.type = Texture::UNSIGNED_BYTE;
+    printf("read compressed texture %s %dx%d : %s, %zu levels (%zu bytes)\n", path, texture.size[0], texture.size[1],
+           info.name, texture.levels.size(), fileSize);
+    return true;
+}
+
+GLenum getCompressedTextureFormat(Texture::Compression compression)
+{
+    return Compressions[compression].glFormat;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <glad/glad.h>
+
+// ktx, ktx2 and dds containers of bc1 to bc7 or etc2 blocks, flipped like the decoded images. The rows of bc1 to bc5
+// blocks are reversed in a copy of the mip levels. etc2, a first level whose rows don't fill its blocks and the formats
+// the driver doesn't support are decoded on the cpu (not bc6h and bc7). bc6h and bc7 are uploaded from the mapping of
+// the file as they are stored, upside down compared to the other images
+
+// query the formats supported by the driver, on the gl thread before any compressed file is read
+void initCompressedTextureSupport();
+bool isCompressedTextureFile(const uint8_t* header, size_t size);
+// map the file and fill texture.levels, or texture.data if the blocks had to be decoded
+bool readCompressedTexture(const char* path, Texture& texture);
+GLenum getCompressedTextureFormat(Texture::Compression compression);
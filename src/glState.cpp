@@ -0,0 +1,182 @@
+#include "glState.h"
+
+#include <assert.h>
+
+namespace {
+
+const GLuint Unknown = ~0x0u;
+
+enum Capability { DEPTH_TEST = 0, BLEND, SCISSOR_TEST, CAPABILITY_COUNT };
+
+struct GLState {
+    GLuint program = Unknown;
+    GLuint vertexArray = Unknown;
+    GLuint framebuffer = Unknown;
+    int activeTexture = -1;
+    GLuint textures[GLStateTextureUnits][2]; // GL_TEXTURE_2D, GL_TEXTURE_3D
+    GLuint samplers[GLStateTextureUnits];
+    int capabilities[CAPABILITY_COUNT]; // -1 unknown, 0 disabled, 1 enabled
+    GLStateStats stats;
+
+    GLState()
+    {
+        for (int unit = 0; unit < GLStateTextureUnits; unit++) {
+            textures[unit][0] = textures[unit][1] = Unknown;
+            samplers[unit] = Unknown;
+        }
+        for (int& capability : capabilities) {
+            capability = -1;
+        }
+    }
+};
+
+GLState gState;
+
+// returns true if the call must be issued and updates the cached value
+bool changeState(GLuint& current, GLuint value)
+{
+    if (current == value) {
+        gState.stats.elided++;
+        return false;
+    }
+    current = value;
+    gState.stats.issued++;
+    return true;
+}
+
+int getCapabilityIndex(GLenum cap)
+{
+    switch (cap) {
+    case GL_DEPTH_TEST:
+        return DEPTH_TEST;
+    case GL_BLEND:
+        return BLEND;
+    case GL_SCISSOR_TEST:
+        return SCISSOR_TEST;
+    }
+    assert(false && "capability not tracked");
+    return DEPTH_TEST;
+}
+
+} // namespace
+
+void resetGLState()
+{
+    const GLStateStats stats = gState.stats;
+    gState = GLState();
+    gState.stats = stats;
+}
+
+void useProgram(GLuint program)
+{
+    if (changeState(gState.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void bindVertexArray(GLuint vertexArray)
+{
+    if (changeState(gState.vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void bindFramebuffer(GLuint framebuffer)
+{
+    if (changeState(gState.framebuffer, framebuffer)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+void setActiveTexture(int unit)
+{
+    if (gState.activeTexture == unit) {
+        gState.stats.elided++;
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + GLenum(unit));
+    gState.activeTexture = unit;
+    gState.stats.issued++;
+}
+
+void bindTexture(int unit, GLenum target, GLuint texture)
+{
+    assert(unit < GLStateTextureUnits && "texture unit not tracked");
+    GLuint& current = gState.textures[unit][target == GL_TEXTURE_3D ? 1 : 0];
+    if (current == texture) {
+        gState.stats.elided++;
+        return;
+    }
+    setActiveTexture(unit);
+    changeState(current, texture);
+    glBindTexture(target, texture);
+}
+
+void bindSampler(int unit, GLuint sampler)
+{
+    assert(unit < GLStateTextureUnits && "texture unit not tracked");
+    if (changeState(gState.samplers[unit], sampler)) {
+        glBindSampler(GLuint(unit), sampler);
+    }
+}
+
+void setCapability(GLenum cap, bool enabled)
+{
+    int& current = gState.capabilities[getCapabilityIndex(cap)];
+    if (current == int(enabled)) {
+        gState.stats.elided++;
+        return;
+    }
+    if (enabled) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+    current = int(enabled);
+    gState.stats.issued++;
+}
+
+// deleting a bound object unbinds it
+void deleteTexture(GLuint texture)
+{
+    glDeleteTextures(1, &texture);
+    for (auto& unitTextures : gState.textures) {
+        for (GLuint& bound : unitTextures) {
+            if (bound == texture) {
+                bound = 0;
+            }
+        }
+    }
+}
+
+// a deleted program stays in use until another one is used, and its name can be reused
+void deleteProgram(GLuint program)
+{
+    glDeleteProgram(program);
+    if (gState.program == program) {
+        gState.program = Unknown;
+    }
+}
+
+void deleteFramebuffer(GLuint framebuffer)
+{
+    glDeleteFramebuffers(1, &framebuffer);
+    if (gState.framebuffer == framebuffer) {
+        gState.framebuffer = 0;
+    }
+}
+
+void deleteVertexArray(GLuint vertexArray)
+{
+    glDeleteVertexArrays(1, &vertexArray);
+    if (gState.vertexArray == vertexArray) {
+        gState.vertexArray = 0;
+    }
+}
+
+GLStateStats endGLStateFrame()
+{
+    const GLStateStats stats = gState.stats;
+    gState.stats = GLStateStats();
+    return stats;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// cache of the GL bindings used by shaderjoy, calls that would not change the current state are skipped.
+// Everything that binds or deletes these objects must go through these functions to keep the cache valid.
+// imgui saves and restores the state it changes so it does not need to be tracked
+
+const int GLStateTextureUnits = 16;
+
+struct GLStateStats {
+    int issued = 0; // GL calls made
+    int elided = 0; // GL calls skipped because the state was already set
+};
+
+// forget the cached state, the next calls are issued
+void resetGLState();
+void useProgram(GLuint program);
+void bindVertexArray(GLuint vertexArray);
+void bindFramebuffer(GLuint framebuffer);
+// target is GL_TEXTURE_2D or GL_TEXTURE_3D
+void bindTexture(int unit, GLenum target, GLuint texture);
+void bindSampler(int unit, GLuint sampler);
+// unit of the next texture calls (glTexParameter, glTexSubImage, ...), a bindTexture skipped because the texture is
+// already bound doesn't change it
+void setActiveTexture(int unit);
+// cap is GL_DEPTH_TEST, GL_BLEND or GL_SCISSOR_TEST
+void setCapability(GLenum cap, bool enabled);
+
+void deleteTexture(GLuint texture);
+void deleteProgram(GLuint program);
+void deleteFramebuffer(GLuint framebuffer);
+void deleteVertexArray(GLuint vertexArray);
+
+// counters since the last call
+GLStateStats endGLStateFrame();
@@ -0,0 +1,130 @@
+#include "halfFloat.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HALF_FLOAT_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define HALF_FLOAT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// the float is rebiased and rounded with integer operations, values too small for a normal half are rounded by
+// adding a magic number so the fpu shifts the mantissa
+uint16_t convertFloatToHalf(float value)
+{
+    const uint32_t f16Max = (127 + 16) << 23;   // this and above are infinities
+    const uint32_t f32Infinity = 255 << 23;     // above are nans
+    const uint32_t minNormal = (127 - 14) << 23; // below are denormals
+    const uint32_t denormalMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half;
+    if (bits >= f16Max) {
+        half = bits > f32Infinity ? 0x7e00 : 0x7c00;
+    } else if (bits < minNormal) {
+        float magic;
+        memcpy(&magic, &denormalMagic, sizeof(magic));
+        float denormal;
+        memcpy(&denormal, &bits, sizeof(denormal));
+        denormal += magic;
+        memcpy(&half, &denormal, sizeof(half));
+        half -= denormalMagic;
+    } else {
+        const uint32_t mantissaOdd = (bits >> 13) & 1;
+        bits += (uint32_t(15 - 127) << 23) + 0xfff;
+        bits += mantissaOdd;
+        half = bits >> 13;
+    }
+    return uint16_t(half | (sign >> 16));
+}
+
+// the exponent is rebiased, denormals are normalized by the fpu with a magic number
+float convertHalfToFloat(uint16_t half)
+{
+    const uint32_t exponentMask = 0x7c00 << 13;
+    const uint32_t magic = 113 << 23;
+    uint32_t bits = uint32_t(half & 0x7fff) << 13;
+    const uint32_t exponent = bits & exponentMask;
+    bits += (127 - 15) << 23;
+    if (exponent == exponentMask) {
+        bits += (128 - 16) << 23; // infinities and nans
+    } else if (exponent == 0) {
+        bits += 1 << 23;
+        float value;
+        float magicValue;
+        memcpy(&value, &bits, sizeof(value));
+        memcpy(&magicValue, &magic, sizeof(magicValue));
+        value -= magicValue;
+        memcpy(&bits, &value, sizeof(bits));
+    }
+    bits |= uint32_t(half & 0x8000) << 16;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+#ifdef HALF_FLOAT_SSE2
+// same steps as the scalar version, both paths are computed and selected with masks
+__m128i convertFloatToHalf4(__m128 value)
+{
+    const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i denormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+    const __m128 sign = _mm_and_ps(_mm_castsi128_ps(_mm_set1_epi32(int(0x80000000u))), value);
+    const __m128 absolute = _mm_xor_ps(value, sign);
+    const __m128i bits = _mm_castps_si128(absolute);
+
+    const __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+    const __m128i special = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+    const __m128i isRegular = _mm_cmpgt_epi32(f16Max, bits);
+    const __m128i isDenormal = _mm_cmpgt_epi32(minNormal, bits);
+
+    const __m128 denormalSum = _mm_add_ps(absolute, _mm_castsi128_ps(denormalMagic));
+    const __m128i denormal = _mm_sub_epi32(_mm_castps_si128(denormalSum), denormalMagic);
+
+    const __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31); // -1 if odd
+    const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, normalBias), mantissaOdd), 13);
+
+    const __m128i finite = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+    const __m128i half = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+    // the sign is shifted arithmetically so the values fit in a signed 16 bits for the saturating pack
+    return _mm_or_si128(half, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+#endif
+
+} // namespace
+
+void convertFloatToHalf(const float* source, uint16_t* destination, size_t count)
+{
+    size_t i = 0;
+#if defined(HALF_FLOAT_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i low = convertFloatToHalf4(_mm_loadu_ps(source + i));
+        const __m128i high = convertFloatToHalf4(_mm_loadu_ps(source + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(low, high));
+    }
+#elif defined(HALF_FLOAT_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1_u16(destination + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(source + i))));
+    }
+#endif
+    for (; i < count; i++) {
+        destination[i] = convertFloatToHalf(source[i]);
+    }
+}
+
+void convertHalfToFloat(const uint16_t* source, float* destination, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = convertHalfToFloat(source[i]);
+    }
+}
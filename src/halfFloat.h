@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// convert 32 bits floats to 16 bits half floats, rounded to nearest even. Out of range values become infinities and
+// nans stay nans. Uses SSE2 or NEON when available
+void convertFloatToHalf(const float* source, uint16_t* destination, size_t count);
+// exact conversion of half floats to 32 bits floats
+void convertHalfToFloat(const uint16_t* source, float* destination, size_t count);
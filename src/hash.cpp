@@ -0,0 +1,13 @@
+#include "hash.h"
+
+uint64_t hashBuffer(const void* data, size_t size, uint64_t seed)
+{
+    const uint64_t prime = 0x100000001b3ull;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= prime;
+    }
+    return hash;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 64 bits FNV-1a, used to identify sources and files. The seed allows to chain several buffers
+const uint64_t HashSeed = 0xcbf29ce484222325ull;
+uint64_t hashBuffer(const void* data, size_t size, uint64_t seed = HashSeed);
@@ -0,0 +1,285 @@
+#include "headless.h"
+
+#include <glad/glad.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+
+bool setupHeadless() { return false; }
+void cleanupHeadless() {}
+
+#else
+
+#include <dlfcn.h>
+
+namespace {
+
+// subset of egl.h and osmesa.h, the headers are not needed since the libraries are loaded with dlopen
+using EGLDisplay = void*;
+using EGLConfig = void*;
+using EGLContext = void*;
+using EGLSurface = void*;
+using EGLBoolean = unsigned int;
+using EGLenum = unsigned int;
+using EGLint = int32_t;
+
+const EGLint EGL_NONE = 0x3038;
+const EGLint EGL_ALPHA_SIZE = 0x3021;
+const EGLint EGL_BLUE_SIZE = 0x3022;
+const EGLint EGL_GREEN_SIZE = 0x3023;
+const EGLint EGL_RED_SIZE = 0x3024;
+const EGLint EGL_SURFACE_TYPE = 0x3033;
+const EGLint EGL_RENDERABLE_TYPE = 0x3040;
+const EGLint EGL_HEIGHT = 0x3056;
+const EGLint EGL_WIDTH = 0x3057;
+const EGLint EGL_PBUFFER_BIT = 0x0001;
+const EGLint EGL_OPENGL_BIT = 0x0008;
+const EGLint EGL_EXTENSIONS = 0x3055;
+const EGLenum EGL_OPENGL_API = 0x30A2;
+const EGLint EGL_CONTEXT_MAJOR_VERSION = 0x3098;
+const EGLint EGL_CONTEXT_MINOR_VERSION = 0x30FB;
+const EGLint EGL_CONTEXT_OPENGL_PROFILE_MASK = 0x30FD;
+const EGLint EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT = 0x0001;
+const EGLenum EGL_PLATFORM_SURFACELESS_MESA = 0x31DD;
+
+using EGLGetProcAddress = void* (*)(const char*);
+using EGLGetDisplay = EGLDisplay (*)(void*);
+using EGLGetPlatformDisplay = EGLDisplay (*)(EGLenum, void*, const EGLint*);
+using EGLInitialize = EGLBoolean (*)(EGLDisplay, EGLint*, EGLint*);
+using EGLTerminate = EGLBoolean (*)(EGLDisplay);
+using EGLQueryString = const char* (*)(EGLDisplay, EGLint);
+using EGLChooseConfig = EGLBoolean (*)(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*);
+using EGLBindAPI = EGLBoolean (*)(EGLenum);
+using EGLCreateContext = EGLContext (*)(EGLDisplay, EGLConfig, EGLContext, const EGLint*);
+using EGLDestroyContext = EGLBoolean (*)(EGLDisplay, EGLContext);
+using EGLCreatePbufferSurface = EGLSurface (*)(EGLDisplay, EGLConfig, const EGLint*);
+using EGLDestroySurface = EGLBoolean (*)(EGLDisplay, EGLSurface);
+using EGLMakeCurrent = EGLBoolean (*)(EGLDisplay, EGLSurface, EGLSurface, EGLContext);
+
+using OSMesaContext = void*;
+const int OSMESA_FORMAT = 0x22;
+const int OSMESA_DEPTH_BITS = 0x30;
+const int OSMESA_PROFILE = 0x33;
+const int OSMESA_CORE_PROFILE = 0x34;
+const int OSMESA_CONTEXT_MAJOR_VERSION = 0x36;
+const int OSMESA_CONTEXT_MINOR_VERSION = 0x37;
+
+using OSMesaCreateContextAttribs = OSMesaContext (*)(const int*, OSMesaContext);
+using OSMesaDestroyContext = void (*)(OSMesaContext);
+using OSMesaMakeCurrent = unsigned char (*)(OSMesaContext, void*, GLenum, GLsizei, GLsizei);
+using OSMesaGetProcAddress = void* (*)(const char*);
+
+// osmesa needs a color buffer to make the context current even if only framebuffer objects are used
+const int OSMesaBufferSize = 16;
+
+struct Headless {
+    void* library = nullptr;
+    EGLDisplay display = nullptr;
+    EGLContext context = nullptr;
+    EGLSurface surface = nullptr;
+    OSMesaContext osmesaContext = nullptr;
+    unsigned char osmesaBuffer[OSMesaBufferSize * OSMesaBufferSize * 4];
+};
+Headless gHeadless;
+
+EGLGetProcAddress gEGLGetProcAddress = nullptr;
+OSMesaGetProcAddress gOSMesaGetProcAddress = nullptr;
+
+template <typename T> T getSymbol(const char* name) { return reinterpret_cast<T>(dlsym(gHeadless.library, name)); }
+
+void* loadEGLProc(const char* name) { return gEGLGetProcAddress(name); }
+void* loadOSMesaProc(const char* name) { return gOSMesaGetProcAddress(name); }
+
+bool hasExtension(const char* extensions, const char* name)
+{
+    if (!extensions) {
+        return false;
+    }
+    const size_t length = strlen(name);
+    for (const char* it = strstr(extensions, name); it; it = strstr(it + length, name)) {
+        const char end = it[length];
+        if ((it == extensions || it[-1] == ' ') && (end == ' ' || end == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void closeLibrary()
+{
+    if (gHeadless.library) {
+        dlclose(gHeadless.library);
+    }
+    gHeadless.library = nullptr;
+}
+
+bool setupEGL()
+{
+    gHeadless.library = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (!gHeadless.library) {
+        return false;
+    }
+
+    gEGLGetProcAddress = getSymbol<EGLGetProcAddress>("eglGetProcAddress");
+    auto eglGetDisplay = getSymbol<EGLGetDisplay>("eglGetDisplay");
+    auto eglInitialize = getSymbol<EGLInitialize>("eglInitialize");
+    auto eglTerminate = getSymbol<EGLTerminate>("eglTerminate");
+    auto eglQueryString = getSymbol<EGLQueryString>("eglQueryString");
+    auto eglChooseConfig = getSymbol<EGLChooseConfig>("eglChooseConfig");
+    auto eglBindAPI = getSymbol<EGLBindAPI>("eglBindAPI");
+    auto eglCreateContext = getSymbol<EGLCreateContext>("eglCreateContext");
+    auto eglCreatePbufferSurface = getSymbol<EGLCreatePbufferSurface>("eglCreatePbufferSurface");
+    auto eglMakeCurrent = getSymbol<EGLMakeCurrent>("eglMakeCurrent");
+    if (!gEGLGetProcAddress || !eglGetDisplay || !eglInitialize || !eglTerminate || !eglQueryString ||
+        !eglChooseConfig || !eglBindAPI || !eglCreateContext || !eglCreatePbufferSurface || !eglMakeCurrent) {
+        closeLibrary();
+        return false;
+    }
+
+    // the surfaceless platform does not need any display server, the default display can need one
+    const char* clientExtensions = eglQueryString(nullptr, EGL_EXTENSIONS);
+    auto eglGetPlatformDisplay =
+        reinterpret_cast<EGLGetPlatformDisplay>(gEGLGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (eglGetPlatformDisplay && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        gHeadless.display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, nullptr, nullptr);
+    }
+    if (!gHeadless.display) {
+        gHeadless.display = eglGetDisplay(nullptr);
+    }
+    if (!gHeadless.display || !eglInitialize(gHeadless.display, nullptr, nullptr)) {
+        gHeadless.display = nullptr;
+        closeLibrary();
+        return false;
+    }
+
+    const bool surfaceless =
+        hasExtension(eglQueryString(gHeadless.display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    const EGLint configAttributes[] = {EGL_SURFACE_TYPE,
+                                       surfaceless ? 0 : EGL_PBUFFER_BIT,
+                                       EGL_RENDERABLE_TYPE,
+                                       EGL_OPENGL_BIT,
+                                       EGL_RED_SIZE,
+                                       8,
+                                       EGL_GREEN_SIZE,
+                                       8,
+                                       EGL_BLUE_SIZE,
+                                       8,
+                                       EGL_ALPHA_SIZE,
+                                       8,
+                                       EGL_NONE};
+    const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                        3,
+                                        EGL_CONTEXT_MINOR_VERSION,
+                                        3,
+                                        EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                        EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                        EGL_NONE};
+    const EGLint pbufferAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (eglChooseConfig(gHeadless.display, configAttributes, &config, 1, &configCount) && configCount == 1 &&
+        eglBindAPI(EGL_OPENGL_API)) {
+        gHeadless.context = eglCreateContext(gHeadless.display, config, nullptr, contextAttributes);
+    }
+    if (gHeadless.context && !surfaceless) {
+        gHeadless.surface = eglCreatePbufferSurface(gHeadless.display, config, pbufferAttributes);
+    }
+    if (!gHeadless.context || (!surfaceless && !gHeadless.surface) ||
+        !eglMakeCurrent(gHeadless.display, gHeadless.surface, gHeadless.surface, gHeadless.context) ||
+        !gladLoadGLLoader(loadEGLProc)) {
+        cleanupHeadless();
+        return false;
+    }
+
+    printf("headless context EGL %s\n", surfaceless ? "surfaceless" : "pbuffer");
+    return true;
+}
+
+bool setupOSMesa()
+{
+    gHeadless.library = dlopen("libOSMesa.so.8", RTLD_NOW | RTLD_LOCAL);
+    if (!gHeadless.library) {
+        gHeadless.library = dlopen("libOSMesa.so", RTLD_NOW | RTLD_LOCAL);
+    }
+    if (!gHeadless.library) {
+        return false;
+    }
+
+    auto osmesaCreateContextAttribs = getSymbol<OSMesaCreateContextAttribs>("OSMesaCreateContextAttribs");
+    auto osmesaMakeCurrent = getSymbol<OSMesaMakeCurrent>("OSMesaMakeCurrent");
+    gOSMesaGetProcAddress = getSymbol<OSMesaGetProcAddress>("OSMesaGetProcAddress");
+    if (!osmesaCreateContextAttribs || !osmesaMakeCurrent || !gOSMesaGetProcAddress) {
+        closeLibrary();
+        return false;
+    }
+
+    const int attributes[] = {OSMESA_FORMAT,
+                              GL_RGBA,
+                              OSMESA_DEPTH_BITS,
+                              0,
+                              OSMESA_PROFILE,
+                              OSMESA_CORE_PROFILE,
+                              OSMESA_CONTEXT_MAJOR_VERSION,
+                              3,
+                              OSMESA_CONTEXT_MINOR_VERSION,
+                              3,
+                              0};
+    gHeadless.osmesaContext = osmesaCreateContextAttribs(attributes, nullptr);
+    if (!gHeadless.osmesaContext ||
+        !osmesaMakeCurrent(gHeadless.osmesaContext, gHeadless.osmesaBuffer, GL_UNSIGNED_BYTE, OSMesaBufferSize,
+                           OSMesaBufferSize) ||
+        !gladLoadGLLoader(loadOSMesaProc)) {
+        cleanupHeadless();
+        return false;
+    }
+
+    printf("headless context OSMesa\n");
+    return true;
+}
+
+} // namespace
+
+bool setupHeadless()
+{
+    if (!setupEGL() && !setupOSMesa()) {
+        printf("no headless context available (EGL or OSMesa), fallback to a hidden window\n");
+        return false;
+    }
+
+    printf("OpenGL %s\n", glGetString(GL_VERSION));
+    printf("%s\n", glGetString(GL_RENDERER));
+    printf("Shading language : %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
+    return true;
+}
+
+void cleanupHeadless()
+{
+    if (gHeadless.display) {
+        auto eglMakeCurrent = getSymbol<EGLMakeCurrent>("eglMakeCurrent");
+        auto eglDestroySurface = getSymbol<EGLDestroySurface>("eglDestroySurface");
+        auto eglDestroyContext = getSymbol<EGLDestroyContext>("eglDestroyContext");
+        auto eglTerminate = getSymbol<EGLTerminate>("eglTerminate");
+        eglMakeCurrent(gHeadless.display, nullptr, nullptr, nullptr);
+        if (gHeadless.surface) {
+            eglDestroySurface(gHeadless.display, gHeadless.surface);
+        }
+        if (gHeadless.context) {
+            eglDestroyContext(gHeadless.display, gHeadless.context);
+        }
+        eglTerminate(gHeadless.display);
+    }
+    if (gHeadless.osmesaContext) {
+        getSymbol<OSMesaDestroyContext>("OSMesaDestroyContext")(gHeadless.osmesaContext);
+    }
+    closeLibrary();
+    gHeadless.display = nullptr;
+    gHeadless.context = nullptr;
+    gHeadless.surface = nullptr;
+    gHeadless.osmesaContext = nullptr;
+}
+
+#endif
@@ -0,0 +1,8 @@
+#pragma once
+
+// GL 3.3 core context without window nor display server for the non interactive runs (--save-frame,
+// --benchmark). EGL is tried first, surfaceless then with a pbuffer, then OSMesa. The libraries are loaded at
+// runtime so shaderjoy still starts when they are missing, setupHeadless returns false in this case.
+// Rendering must go in a framebuffer object, the default framebuffer is not usable
+bool setupHeadless();
+void cleanupHeadless();
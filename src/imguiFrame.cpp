@@ -1,12 +1,77 @@
 #include "Application.h"
 #include "UniformList.h"
+#include "timer.h"
+#include <GLFW/glfw3.h>
 #include <imgui/imgui.h>
 #include <stdio.h>
 
 void ImGui_ImplOpenGL3_NewFrame();
-void ImGui_ImplGlfw_NewFrame();
 void ImGui_ImplOpenGL3_RenderDrawData(ImDrawData*);
 
+namespace {
+// like imgui_impl_glfw, a press is kept for one frame so a click shorter than a frame is not missed
+bool gMouseJustPressed[5] = {false, false, false, false, false};
+bool gMouseDown[5] = {false, false, false, false, false};
+double gLastFrameTime = 0.0;
+} // namespace
+
+// replaces the glfw callbacks of imgui_impl_glfw, the window is owned by the main thread
+void processIMGUIInput(const InputEvent& event)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    switch (event.type) {
+    case InputEvent::MOUSE_BUTTON:
+        if (event.key >= 0 && event.key < 5) {
+            gMouseDown[event.key] = event.action == GLFW_PRESS;
+            gMouseJustPressed[event.key] = gMouseJustPressed[event.key] || event.action == GLFW_PRESS;
+        }
+        break;
+    case InputEvent::SCROLL:
+        io.MouseWheelH += event.x;
+        io.MouseWheel += event.y;
+        break;
+    case InputEvent::KEY:
+        if (event.key >= 0 && event.key < IM_ARRAYSIZE(io.KeysDown)) {
+            if (event.action == GLFW_PRESS) {
+                io.KeysDown[event.key] = true;
+            } else if (event.action == GLFW_RELEASE) {
+                io.KeysDown[event.key] = false;
+            }
+        }
+        io.KeyCtrl = (event.mods & GLFW_MOD_CONTROL) != 0;
+        io.KeyShift = (event.mods & GLFW_MOD_SHIFT) != 0;
+        io.KeyAlt = (event.mods & GLFW_MOD_ALT) != 0;
+        io.KeySuper = (event.mods & GLFW_MOD_SUPER) != 0;
+        break;
+    case InputEvent::CHAR:
+        io.AddInputCharacter(unsigned(event.key));
+        break;
+    case InputEvent::RESIZE:
+    case InputEvent::CURSOR:
+    case InputEvent::FOCUS:
+    case InputEvent::ICONIFY:
+        break;
+    }
+}
+
+// outline of the selection in progress or of the region shaded, in window coordinates
+void drawRegionOutline(const Application* app)
+{
+    const RegionOfInterest& region = app->region;
+    const ImU32 color = IM_COL32(255, 200, 0, 255);
+    if (region.selecting) {
+        ImGui::GetForegroundDrawList()->AddRect(ImVec2(region.dragStart[0], region.dragStart[1]),
+                                                ImVec2(region.dragEnd[0], region.dragEnd[1]), color);
+    } else if (region.active && !region.magnify) {
+        const float pixelRatio = app->pixelRatio;
+        const float top = float(app->height) - float(region.y + region.height) / pixelRatio;
+        const float left = float(region.x) / pixelRatio;
+        ImGui::GetForegroundDrawList()->AddRect(
+            ImVec2(left, top), ImVec2(left + float(region.width) / pixelRatio, top + float(region.height) / pixelRatio),
+            color);
+    }
+}
+
 size_t printImGuiShaderLine(const Line& line, LineType lineType, int indentationError, const char* buffer)
 {
     (void)buffer;
@@ -33,7 +98,20 @@ void frameIMGUI(Application* app, const UniformList& uniformList)
     (void)app;
 
     ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(float(app->width), float(app->height));
+    io.DisplayFramebufferScale = ImVec2(app->pixelRatio, app->pixelRatio);
+    const double now = getTimeInMS();
+    io.DeltaTime = gLastFrameTime > 0.0 && now > gLastFrameTime ? float((now - gLastFrameTime) / 1000.0)
+                                                                 : 1.0f / 60.0f;
+    gLastFrameTime = now;
+    io.MousePos = ImVec2(app->cursor[0], app->cursor[1]);
+    for (int i = 0; i < 5; i++) {
+        io.MouseDown[i] = gMouseJustPressed[i] || gMouseDown[i];
+        gMouseJustPressed[i] = false;
+    }
+
     ImGui::NewFrame();
 
 #if 0
@@ -53,6 +131,11 @@ void frameIMGUI(Application* app, const UniformList& uniformList)
     const int height = static_cast<int>(double(app->height) * app->pixelRatio);
     index += sprintf(&menuTitle[index], "     %d x %d ", width, height);
     index += sprintf(&menuTitle[index], "     compile %s", app->shaderReport.compileSuccess ? "success" : "failed");
+    const Accumulation& accumulation = app->accumulation;
+    if (accumulation.enabled) {
+        index += sprintf(&menuTitle[index], "     samples %d%s", accumulation.sampleCount,
+                         accumulation.converged ? " (converged)" : "");
+    }
     index += sprintf(&menuTitle[index], "###AnimatedTitle");
     menuTitle[index] = 0;
 
@@ -60,6 +143,91 @@ void frameIMGUI(Application* app, const UniformList& uniformList)
     ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
     if (ImGui::Begin(menuTitle)) {
 
+        if (accumulation.enabled) {
+            ImGui::Text("Accumulation %d / %d samples", accumulation.sampleCount, accumulation.maxSamples);
+            if (accumulation.noise >= 0.0f) {
+                ImGui::Text("Noise %f / %f", double(accumulation.noise), double(accumulation.noiseThreshold));
+            }
+            ImGui::Separator();
+        }
+
+        Latency& latency = app->latency;
+        ImGui::Checkbox("Low latency", &latency.lowLatency);
+        ImGui::SameLine();
+        ImGui::Text("input to gpu done %.1f ms, %d frames queued", double(latency.latencyMS), latency.count);
+        ImGui::Separator();
+
+        Checkerboard& checkerboard = app->checkerboard;
+        ImGui::Checkbox("Checkerboard", &checkerboard.enabled);
+        if (checkerboard.enabled) {
+            ImGui::SameLine();
+            const float speedup = getCheckerboardSpeedup(checkerboard);
+            if (speedup > 0.0f) {
+                ImGui::Text("speedup %.2fx (full %.2f ms, checkerboard %.2f ms)", double(speedup),
+                            double(checkerboard.fullMS), double(checkerboard.checkerboardMS));
+            } else {
+                ImGui::Text("measuring");
+            }
+        }
+        ImGui::Separator();
+
+        const TiledRender& tiled = app->tiled;
+        if (tiled.enabled) {
+            ImGui::Text("Tiles %d / %d of %d pixels, last pass %.1f ms", tiled.nextTile, tiled.tileCount,
+                        tiled.tileSize, double(tiled.passMS));
+            if (tiled.aborted) {
+                ImGui::Text("Shader stopped by the watchdog, save it to run it again");
+            }
+            ImGui::Separator();
+        }
+
+        const RegionOfInterest& region = app->region;
+        if (region.active) {
+            ImGui::Text("Region %d x %d at %d, %d%s: 'm' to magnify, 'r' to remove", region.width, region.height,
+                        region.x, region.y, region.magnify ? " magnified" : "");
+        } else {
+            ImGui::Text("Shift + drag to shade only a region");
+        }
+        ImGui::Separator();
+
+        // only the sampler bound to the channel changes, the texture is not loaded again
+        const char* const filterNames[] = {"linear", "linear_mipmap_linear", "nearest"};
+        const char* const wrapNames[] = {"repeat", "clamp"};
+        bool hasChannel = false;
+        for (int channel = 0; channel < 4; channel++) {
+            ChannelSampler& sampler = app->samplers.channels[channel];
+            if (!sampler.enabled) {
+                continue;
+            }
+            int filter = int(sampler.filter);
+            int wrap = int(sampler.wrap);
+            ImGui::PushID(channel);
+            ImGui::Text("iChannel%d", channel);
+            ImGui::SameLine();
+            ImGui::PushItemWidth(180.0f);
+            if (ImGui::Combo("filter", &filter, filterNames, 3)) {
+                sampler.filter = Texture::Filter(filter);
+                app->samplers.changed = true;
+            }
+            ImGui::SameLine();
+            if (ImGui::Combo("wrap", &wrap, wrapNames, 2)) {
+                sampler.wrap = Texture::Wrap(wrap);
+                app->samplers.changed = true;
+            }
+            ImGui::PopItemWidth();
+            ImGui::PopID();
+            hasChannel = true;
+        }
+        if (hasChannel) {
+            ImGui::Separator();
+        }
+
+        ImGui::Text("GL state calls %d issued, %d elided", app->glStats.issued, app->glStats.elided);
+        const TextureStorageStats textureStats = getTextureStorageStats();
+        ImGui::Text("Texture reloads %d in place, %d reallocated, %d in changed rectangles", textureStats.inPlace,
+                    textureStats.reallocations, textureStats.partial);
+        ImGui::Separator();
+
         if (!app->shaderReport.compileSuccess) {
             ImGui::Text("Shader Errors %d", int(app->shaderReport.errorLines.size()));
 #if 0
@@ -86,6 +254,8 @@ void frameIMGUI(Application* app, const UniformList& uniformList)
     }
     ImGui::End();
 
+    drawRegionOutline(app);
+
     // Rendering
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -34,7 +34,8 @@ void initIMGUI(GLFWwindow* window)
     // ImGui::StyleColorsClassic();
 
     // Setup Platform/Renderer bindings
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    // the inputs are fed by the render thread from the queued window events, see processIMGUIInput
+    ImGui_ImplGlfw_InitForOpenGL(window, false);
     ImGui_ImplOpenGL3_Init(glslVersion);
 
     // Load Fonts
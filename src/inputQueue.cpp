@@ -0,0 +1,191 @@
+#include "inputQueue.h"
+
+#include <string.h>
+
+#include <chrono>
+
+namespace {
+
+uint32_t getCoalescedBit(InputEvent::Type type) { return 1u << uint32_t(type); }
+
+bool isCoalesced(InputEvent::Type type)
+{
+    return type == InputEvent::CURSOR || type == InputEvent::RESIZE || type == InputEvent::SCROLL;
+}
+
+uint64_t packPair(float x, float y)
+{
+    uint32_t a, b;
+    memcpy(&a, &x, sizeof(a));
+    memcpy(&b, &y, sizeof(b));
+    return uint64_t(a) | (uint64_t(b) << 32);
+}
+
+void unpackPair(uint64_t pair, float& x, float& y)
+{
+    const uint32_t a = uint32_t(pair);
+    const uint32_t b = uint32_t(pair >> 32);
+    memcpy(&x, &a, sizeof(x));
+    memcpy(&y, &b, sizeof(y));
+}
+
+// the mutex is taken so the notification can't be lost between the check and the sleep of the consumer
+void notifyConsumer(InputQueue& queue)
+{
+    {
+        std::lock_guard<std::mutex> lock(queue.wakeMutex);
+    }
+    queue.wakeCondition.notify_one();
+}
+
+// the wake mutex is only taken when the consumer can be sleeping
+void addPending(InputQueue& queue)
+{
+    if (queue.pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        notifyConsumer(queue);
+    }
+}
+
+void pushCoalesced(InputQueue& queue, const InputEvent& event)
+{
+    if (event.type == InputEvent::CURSOR) {
+        queue.cursor.store(packPair(event.x, event.y), std::memory_order_relaxed);
+        queue.cursorTime.store(event.time, std::memory_order_relaxed);
+    } else if (event.type == InputEvent::RESIZE) {
+        queue.size.store(packPair(event.x, event.y), std::memory_order_relaxed);
+    } else {
+        // the consumer resets the sum when it pops it
+        uint64_t previous = queue.scroll.load(std::memory_order_relaxed);
+        float x, y;
+        do {
+            unpackPair(previous, x, y);
+        } while (!queue.scroll.compare_exchange_weak(previous, packPair(x + event.x, y + event.y),
+                                                     std::memory_order_relaxed));
+    }
+
+    // the release publishes the value, a type already waiting is not counted twice
+    const uint32_t bit = getCoalescedBit(event.type);
+    if (!(queue.coalesced.fetch_or(bit, std::memory_order_acq_rel) & bit)) {
+        addPending(queue);
+    }
+}
+
+bool popCoalesced(InputQueue& queue, InputEvent& event)
+{
+    const uint32_t bits = queue.coalesced.load(std::memory_order_acquire);
+    for (InputEvent::Type type : {InputEvent::RESIZE, InputEvent::CURSOR, InputEvent::SCROLL}) {
+        const uint32_t bit = getCoalescedBit(type);
+        if (!(bits & bit)) {
+            continue;
+        }
+        queue.coalesced.fetch_and(~bit, std::memory_order_acq_rel);
+        event = InputEvent();
+        event.type = type;
+        if (type == InputEvent::CURSOR) {
+            unpackPair(queue.cursor.load(std::memory_order_relaxed), event.x, event.y);
+            event.time = queue.cursorTime.load(std::memory_order_relaxed);
+        } else if (type == InputEvent::RESIZE) {
+            unpackPair(queue.size.load(std::memory_order_relaxed), event.x, event.y);
+        } else {
+            unpackPair(queue.scroll.exchange(0, std::memory_order_relaxed), event.x, event.y);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool popDrained(InputQueue& queue, InputEvent& event)
+{
+    if (queue.drainedIndex == queue.drained.size()) {
+        return false;
+    }
+    event = queue.drained[queue.drainedIndex++];
+    if (queue.drainedIndex == queue.drained.size()) {
+        queue.drained.clear();
+        queue.drainedIndex = 0;
+    }
+    return true;
+}
+
+bool popRing(InputQueue& queue, InputEvent& event)
+{
+    const uint32_t head = queue.head.load(std::memory_order_relaxed);
+    if (head == queue.tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+    event = queue.events[head % InputQueue::Capacity];
+    queue.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+// the overflow events were pushed after the ones of the ring, they are taken once the ring is empty
+bool popOverflow(InputQueue& queue, InputEvent& event)
+{
+    if (!queue.overflowing.load(std::memory_order_acquire)) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue.overflowMutex);
+        queue.drained.swap(queue.overflow);
+        queue.overflowing.store(false, std::memory_order_release);
+    }
+    return popDrained(queue, event);
+}
+
+bool hasPendingInput(const InputQueue& queue) { return queue.pending.load(std::memory_order_acquire) > 0; }
+
+} // namespace
+
+void pushInput(InputQueue& queue, const InputEvent& event)
+{
+    if (isCoalesced(event.type)) {
+        pushCoalesced(queue, event);
+        return;
+    }
+
+    const uint32_t tail = queue.tail.load(std::memory_order_relaxed);
+    if (queue.overflowing.load(std::memory_order_acquire) ||
+        tail - queue.head.load(std::memory_order_acquire) == InputQueue::Capacity) {
+        std::lock_guard<std::mutex> lock(queue.overflowMutex);
+        queue.overflow.push_back(event);
+        queue.overflowing.store(true, std::memory_order_release);
+    } else {
+        queue.events[tail % InputQueue::Capacity] = event;
+        queue.tail.store(tail + 1, std::memory_order_release);
+    }
+    addPending(queue);
+}
+
+bool popInput(InputQueue& queue, InputEvent& event)
+{
+    if (popDrained(queue, event) || popRing(queue, event) || popOverflow(queue, event) ||
+        popCoalesced(queue, event)) {
+        queue.pending.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    return false;
+}
+
+void waitInput(InputQueue& queue)
+{
+    std::unique_lock<std::mutex> lock(queue.wakeMutex);
+    queue.wakeCondition.wait(lock, [&queue]() { return queue.woken || hasPendingInput(queue); });
+    queue.woken = false;
+}
+
+void waitInputFor(InputQueue& queue, double ms)
+{
+    std::unique_lock<std::mutex> lock(queue.wakeMutex);
+    queue.wakeCondition.wait_for(lock, std::chrono::duration<double, std::milli>(ms),
+                                 [&queue]() { return queue.woken || hasPendingInput(queue); });
+    queue.woken = false;
+}
+
+void wakeInput(InputQueue& queue)
+{
+    {
+        std::lock_guard<std::mutex> lock(queue.wakeMutex);
+        queue.woken = true;
+    }
+    queue.wakeCondition.notify_one();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// window events pushed by the main thread (GLFW callbacks) and consumed by the render thread
+struct InputEvent {
+    enum Type { RESIZE = 0, CURSOR, MOUSE_BUTTON, SCROLL, KEY, CHAR, FOCUS, ICONIFY };
+    Type type = RESIZE;
+    float x = 0.0f; // RESIZE width, CURSOR, MOUSE_BUTTON and SCROLL position or offset
+    float y = 0.0f;
+    int key = 0; // KEY key, MOUSE_BUTTON button, CHAR codepoint, FOCUS and ICONIFY state
+    int action = 0;
+    int mods = 0;
+    double time = 0.0; // getTimeInMS when queued, used to measure the latency
+};
+
+// single producer single consumer queue. The other events go through a lock-free ring, when it's full they are
+// appended to an overflow list under a mutex so none is lost. CURSOR, RESIZE and SCROLL only keep their latest value
+// in atomics (the scroll offsets are summed) and are delivered once the ring is empty. The wake mutex is only taken
+// when the queue goes from empty to not empty or to sleep when there is nothing to do
+struct InputQueue {
+    static const uint32_t Capacity = 256;
+    InputEvent events[Capacity];
+    std::atomic<uint32_t> head{0}; // next event to pop, written by the consumer
+    std::atomic<uint32_t> tail{0}; // next event to push, written by the producer
+
+    std::atomic<uint32_t> coalesced{0}; // one bit per coalesced type waiting to be popped
+    std::atomic<uint64_t> cursor{0};    // x and y floats packed
+    std::atomic<double> cursorTime{0.0};
+    std::atomic<uint64_t> size{0};
+    std::atomic<uint64_t> scroll{0};
+
+    std::mutex overflowMutex;
+    std::vector<InputEvent> overflow;     // events pushed while the ring was full, in order
+    std::atomic<bool> overflowing{false}; // the next events go to overflow until the consumer takes it
+    std::vector<InputEvent> drained;      // overflow taken by the consumer, popped before the ring
+    size_t drainedIndex = 0;
+
+    std::atomic<int> pending{0}; // events not popped yet
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    bool woken = false;
+};
+
+void pushInput(InputQueue& queue, const InputEvent& event);
+bool popInput(InputQueue& queue, InputEvent& event);
+
+// block the consumer until an event is pushed or wakeInput is called
+void waitInput(InputQueue& queue);
+// same as waitInput but returns after the given time if nothing happens
+void waitInputFor(InputQueue& queue, double ms);
+// wake the consumer without event, used when a file changed or to quit
+void wakeInput(InputQueue& queue);
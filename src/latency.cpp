@@ -0,0 +1,58 @@
+#include "latency.h"
+#include "timer.h"
+
+namespace {
+
+void collectFrame(Latency& latency, GLuint64 timeout)
+{
+    GLsync fence = latency.fences[latency.first];
+    const GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return;
+    }
+    glDeleteSync(fence);
+
+    const double inputTime = latency.inputTimes[latency.first];
+    if (inputTime > 0.0 && status != GL_WAIT_FAILED) {
+        const float ms = float(getTimeInMS() - inputTime);
+        latency.latencyMS = latency.latencyMS == 0.0f ? ms : latency.latencyMS * 0.9f + ms * 0.1f;
+    }
+    latency.first = (latency.first + 1) % Latency::MaxFrames;
+    latency.count--;
+}
+
+} // namespace
+
+void waitFramesInFlight(Latency& latency)
+{
+    // the completion time is only known when the fence is checked so the frames are polled even when not waited
+    const GLuint64 timeout = latency.lowLatency ? GL_TIMEOUT_IGNORED : 0;
+    while (latency.count > 0) {
+        const int count = latency.count;
+        collectFrame(latency, timeout);
+        if (latency.count == count) {
+            break;
+        }
+    }
+}
+
+void endLatencyFrame(Latency& latency)
+{
+    if (latency.count == Latency::MaxFrames) {
+        collectFrame(latency, GL_TIMEOUT_IGNORED);
+    }
+    const int index = (latency.first + latency.count) % Latency::MaxFrames;
+    latency.fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    latency.inputTimes[index] = latency.inputTime;
+    latency.inputTime = 0.0;
+    latency.count++;
+}
+
+void cleanupLatency(Latency& latency)
+{
+    for (int i = 0; i < latency.count; i++) {
+        glDeleteSync(latency.fences[(latency.first + i) % Latency::MaxFrames]);
+    }
+    latency.first = 0;
+    latency.count = 0;
+}
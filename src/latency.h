@@ -0,0 +1,26 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// the frames queued to the gpu are tracked with a fence inserted after each swap. In low latency mode the render
+// thread waits for the previous frame before reading the inputs: at most one frame is queued and the cursor is
+// latched as late as possible before the draw. The latency is measured from the last input event used by a frame to
+// the gpu completion of this frame, the scanout adds up to one refresh period
+struct Latency {
+    static const int MaxFrames = 4;
+
+    bool lowLatency = false;
+    GLsync fences[MaxFrames] = {};
+    double inputTimes[MaxFrames] = {}; // time of the last input used by each frame in flight, 0 if none
+    int first = 0;
+    int count = 0;
+
+    double inputTime = 0.0; // last input event consumed since the previous frame, 0 if none
+    float latencyMS = 0.0f; // averaged
+};
+
+// collect the completed frames, wait for all of them in low latency mode
+void waitFramesInFlight(Latency& latency);
+// called after the swap
+void endLatencyFrame(Latency& latency);
+void cleanupLatency(Latency& latency);
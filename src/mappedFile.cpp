@@ -0,0 +1,83 @@
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool mapFile(const char* path, MappedFile& mapped)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return false;
+    }
+    mapped.data = static_cast<const uint8_t*>(data);
+    mapped.size = size_t(size.QuadPart);
+    mapped.file = file;
+    mapped.mapping = mapping;
+    return true;
+}
+
+void unmapFile(MappedFile& mapped)
+{
+    if (mapped.data) {
+        UnmapViewOfFile(mapped.data);
+        CloseHandle(mapped.mapping);
+        CloseHandle(mapped.file);
+    }
+    mapped = MappedFile();
+}
+
+#else
+
+bool mapFile(const char* path, MappedFile& mapped)
+{
+    const int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // the mapping stays valid after closing the descriptor
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    // the upload reads the whole volume once, in order
+    madvise(data, size_t(st.st_size), MADV_SEQUENTIAL);
+    mapped.data = static_cast<const uint8_t*>(data);
+    mapped.size = size_t(st.st_size);
+    return true;
+}
+
+void unmapFile(MappedFile& mapped)
+{
+    if (mapped.data) {
+        munmap(const_cast<uint8_t*>(mapped.data), mapped.size);
+    }
+    mapped = MappedFile();
+}
+
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// read only mapping of a whole file, the pages are read by the system when they are accessed
+struct MappedFile {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+bool mapFile(const char* path, MappedFile& mapped);
+// safe to call on a file not mapped
+void unmapFile(MappedFile& mapped);
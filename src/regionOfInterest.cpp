@@ -0,0 +1,126 @@
+#include "regionOfInterest.h"
+#include "glState.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace {
+
+bool isMagnified(const RegionOfInterest& region) { return region.active && region.magnify; }
+
+// part of the frame displayed when magnified, in pixels: the region grown to the aspect ratio of the window
+void getDisplayedRegion(const RegionOfInterest& region, int width, int height, float displayed[4])
+{
+    const float scale = std::min(float(width) / float(region.width), float(height) / float(region.height));
+    displayed[2] = float(width) / scale;
+    displayed[3] = float(height) / scale;
+    displayed[0] = float(region.x) + (float(region.width) - displayed[2]) * 0.5f;
+    displayed[1] = float(region.y) + (float(region.height) - displayed[3]) * 0.5f;
+}
+
+} // namespace
+
+void beginRegionSelection(RegionOfInterest& region, float x, float y)
+{
+    region.selecting = true;
+    region.dragStart[0] = region.dragEnd[0] = x;
+    region.dragStart[1] = region.dragEnd[1] = y;
+}
+
+void updateRegionSelection(RegionOfInterest& region, float x, float y)
+{
+    region.dragEnd[0] = x;
+    region.dragEnd[1] = y;
+}
+
+void endRegionSelection(RegionOfInterest& region, float pixelRatio, int viewportWidth, int viewportHeight)
+{
+    region.selecting = false;
+
+    // window coordinates have their origin top left
+    const float left = std::min(region.dragStart[0], region.dragEnd[0]) * pixelRatio;
+    const float right = std::max(region.dragStart[0], region.dragEnd[0]) * pixelRatio;
+    const float top = std::min(region.dragStart[1], region.dragEnd[1]) * pixelRatio;
+    const float bottom = std::max(region.dragStart[1], region.dragEnd[1]) * pixelRatio;
+    const int x0 = std::max(int(floorf(left)), 0);
+    const int x1 = std::min(int(ceilf(right)), viewportWidth);
+    const int y0 = std::max(viewportHeight - int(ceilf(bottom)), 0);
+    const int y1 = std::min(viewportHeight - int(floorf(top)), viewportHeight);
+
+    // a click without drag removes the region
+    if (x1 - x0 < 2 || y1 - y0 < 2) {
+        clearRegionOfInterest(region);
+        return;
+    }
+    region.active = true;
+    region.x = x0;
+    region.y = y0;
+    region.width = x1 - x0;
+    region.height = y1 - y0;
+    resetRegionOfInterest(region);
+}
+
+void clearRegionOfInterest(RegionOfInterest& region)
+{
+    region.active = false;
+    region.magnify = false;
+}
+
+bool setupRegionOfInterest(RegionOfInterest& region, int width, int height)
+{
+    if (region.cache.framebuffer && region.cache.width == width && region.cache.height == height) {
+        return true;
+    }
+    destroyRenderTarget(region.cache);
+    resetRegionOfInterest(region);
+    return createRenderTarget(region.cache, width, height, GL_RGBA8);
+}
+
+void resetRegionOfInterest(RegionOfInterest& region) { region.cacheValid = false; }
+
+void drawRegionOfInterest(RegionOfInterest& region, const std::function<void()>& draw)
+{
+    bindFramebuffer(region.cache.framebuffer);
+    if (region.cacheValid) {
+        setCapability(GL_SCISSOR_TEST, true);
+        glScissor(region.x, region.y, region.width, region.height);
+        draw();
+        setCapability(GL_SCISSOR_TEST, false);
+    } else {
+        draw();
+        region.cacheValid = true;
+    }
+    bindFramebuffer(0);
+}
+
+void presentRegionOfInterest(const RegionOfInterest& region, GLuint texture, int width, int height)
+{
+    if (!isMagnified(region)) {
+        presentTexture(texture, width, height);
+        return;
+    }
+    float displayed[4];
+    getDisplayedRegion(region, width, height, displayed);
+    const float uv[4] = {displayed[0] / float(width), displayed[1] / float(height), displayed[2] / float(width),
+                         displayed[3] / float(height)};
+    presentTextureRegion(texture, width, height, uv);
+}
+
+void mapRegionCursor(const RegionOfInterest& region, float pixelRatio, int width, int height, float& x, float& y)
+{
+    if (!isMagnified(region)) {
+        return;
+    }
+    float displayed[4];
+    getDisplayedRegion(region, width, height, displayed);
+    const float framebufferX = displayed[0] + x * pixelRatio / float(width) * displayed[2];
+    const float framebufferY = displayed[1] + (float(height) - y * pixelRatio) / float(height) * displayed[3];
+    x = framebufferX / pixelRatio;
+    y = (float(height) - framebufferY) / pixelRatio;
+}
+
+void cleanupRegionOfInterest(RegionOfInterest& region)
+{
+    destroyRenderTarget(region.cache);
+    region.cacheValid = false;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "renderTarget.h"
+
+#include <functional>
+
+// only a rectangle selected in the window is shaded again each frame, the rest of the frame comes from a cached full
+// frame. The shader keeps the full frame viewport and is only scissored so fragCoord and iResolution do not change.
+// The region can be magnified to fill the window, pixels are not filtered to show them as they are shaded
+struct RegionOfInterest {
+    bool selecting = false;            // drag in progress
+    float dragStart[2] = {0.0f, 0.0f}; // window coordinates
+    float dragEnd[2] = {0.0f, 0.0f};
+
+    bool active = false;
+    int x = 0; // framebuffer pixels, origin bottom left like glScissor
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    bool magnify = false;
+
+    RenderTarget cache; // full frame, updated only in the region while the full frame is valid
+    bool cacheValid = false;
+};
+
+void beginRegionSelection(RegionOfInterest& region, float x, float y);
+void updateRegionSelection(RegionOfInterest& region, float x, float y);
+// the region is active if the selection is larger than one pixel
+void endRegionSelection(RegionOfInterest& region, float pixelRatio, int viewportWidth, int viewportHeight);
+void clearRegionOfInterest(RegionOfInterest& region);
+
+// (re)create the cache if needed, returns false if it can't be created
+bool setupRegionOfInterest(RegionOfInterest& region, int width, int height);
+// invalidate the cache, the next frame is drawn entirely
+void resetRegionOfInterest(RegionOfInterest& region);
+// draw the region into the cache, or the whole frame if the cache is not valid
+void drawRegionOfInterest(RegionOfInterest& region, const std::function<void()>& draw);
+// draw the texture in the current framebuffer, magnified around the region if enabled
+void presentRegionOfInterest(const RegionOfInterest& region, GLuint texture, int width, int height);
+// convert a cursor position on the magnified window to the position in the full frame
+void mapRegionCursor(const RegionOfInterest& region, float pixelRatio, int width, int height, float& x, float& y);
+void cleanupRegionOfInterest(RegionOfInterest& region);
@@ -0,0 +1,227 @@
+#include "renderServer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace {
+
+const char* const JobExtension = ".job";
+
+bool hasJobExtension(const char* name)
+{
+    const size_t size = strlen(name);
+    const size_t extensionSize = strlen(JobExtension);
+    return size > extensionSize && strcmp(name + size - extensionSize, JobExtension) == 0;
+}
+
+std::string resolvePath(const char* directory, const char* path)
+{
+    const bool absolute = path[0] == '/' || path[0] == '\\' || (path[0] && path[1] == ':');
+    if (absolute) {
+        return path;
+    }
+    return std::string(directory) + "/" + path;
+}
+
+void writeString(FILE* file, const char* value)
+{
+    fputc('"', file);
+    for (const char* c = value; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+            fputc(*c, file);
+        } else if (*c == '\n') {
+            fputs("\\n", file);
+        } else if (*c == '\t') {
+            fputs("\\t", file);
+        } else if (static_cast<unsigned char>(*c) >= 0x20) {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+void writeStringList(FILE* file, const char* name, const std::vector<std::string>& values)
+{
+    fprintf(file, "  \"%s\": [", name);
+    for (size_t i = 0; i < values.size(); i++) {
+        fputs(i ? ", " : "", file);
+        writeString(file, values[i].c_str());
+    }
+    fprintf(file, "]");
+}
+
+} // namespace
+
+bool findRenderJob(const char* directory, std::string& jobPath)
+{
+    std::string first;
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA((std::string(directory) + "\\*.job").c_str(), &entry);
+    if (find == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    do {
+        if (hasJobExtension(entry.cFileName) && (first.empty() || first > entry.cFileName)) {
+            first = entry.cFileName;
+        }
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        return false;
+    }
+    while (const dirent* entry = readdir(dir)) {
+        if (hasJobExtension(entry->d_name) && (first.empty() || first > entry->d_name)) {
+            first = entry->d_name;
+        }
+    }
+    closedir(dir);
+#endif
+    if (first.empty()) {
+        return false;
+    }
+    jobPath = std::string(directory) + "/" + first;
+    return true;
+}
+
+bool readRenderJob(const char* directory, const std::string& jobPath, RenderJob& job, std::string& error)
+{
+    job.path = jobPath;
+    FILE* file = fopen(jobPath.c_str(), "rb");
+    if (!file) {
+        error = "cant open the job file";
+        return false;
+    }
+
+    char line[4096];
+    char message[4096 + 64];
+    int lineNumber = 0;
+    bool success = true;
+    while (success && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        std::vector<const char*> tokens;
+        for (char* token = strtok(line, " \t\r\n"); token; token = strtok(nullptr, " \t\r\n")) {
+            tokens.push_back(token);
+        }
+        if (tokens.empty() || tokens[0][0] == '#') {
+            continue;
+        }
+
+        const char* key = tokens[0];
+        const size_t count = tokens.size();
+        if (strcmp(key, "shader") == 0 && count == 2) {
+            job.files.push_back(WatchFile(WatchFile::SHADER, resolvePath(directory, tokens[1])));
+        } else if (strncmp(key, "texture", 7) == 0 && key[7] >= '0' && key[7] <= '3' && !key[8] &&
+                   (count == 2 || (count == 3 && tokens[1][0] == '['))) {
+            WatchFile entry;
+            entry.type = WatchFile::Type(WatchFile::TEXTURE0 + (key[7] - '0'));
+            entry.texture.target = Texture::TEXTURE_2D;
+            if (count == 3 && !parseTextureBlock(tokens.data(), 1, entry.texture)) {
+                snprintf(message, sizeof(message), "line %d: malformed texture description %s", lineNumber,
+                         tokens[1]);
+                error = message;
+                success = false;
+            }
+            entry.path = resolvePath(directory, tokens[count - 1]);
+            job.files.push_back(entry);
+        } else if (strcmp(key, "size") == 0 && count == 2) {
+            if (sscanf(tokens[1], "%dx%d", &job.width, &job.height) != 2 || job.width <= 0 || job.height <= 0) {
+                snprintf(message, sizeof(message), "line %d: size should look like 512x288", lineNumber);
+                error = message;
+                success = false;
+            }
+        } else if (strcmp(key, "time") == 0 && count >= 2) {
+            for (size_t i = 1; i < count; i++) {
+                job.times.push_back(float(atof(tokens[i])));
+            }
+        } else if (strcmp(key, "output") == 0 && count == 2) {
+            job.output = resolvePath(directory, tokens[1]);
+        } else {
+            snprintf(message, sizeof(message), "line %d: unknown entry %s", lineNumber, key);
+            error = message;
+            success = false;
+        }
+    }
+    fclose(file);
+    if (!success) {
+        return false;
+    }
+
+    bool hasShader = false;
+    for (auto&& entry : job.files) {
+        hasShader = hasShader || entry.type == WatchFile::SHADER;
+    }
+    if (!hasShader || job.output.empty()) {
+        error = "a job needs a shader and an output";
+        return false;
+    }
+    if (job.times.empty()) {
+        job.times.push_back(0.0f);
+    }
+    if (job.times.size() > 1 && job.output.find("%d") == std::string::npos) {
+        error = "the output needs %d to render several times";
+        return false;
+    }
+    return true;
+}
+
+std::string getRenderJobOutput(const RenderJob& job, size_t timeIndex)
+{
+    std::string output = job.output;
+    const size_t position = output.find("%d");
+    if (position != std::string::npos) {
+        output.replace(position, 2, std::to_string(timeIndex));
+    }
+    return output;
+}
+
+bool finishRenderJob(const std::string& jobPath, const RenderJobResult& result)
+{
+    const std::string resultPath = jobPath.substr(0, jobPath.size() - strlen(JobExtension)) + ".result.json";
+    FILE* file = fopen(resultPath.c_str(), "wb");
+    if (!file) {
+        printf("cant open file %s\n", resultPath.c_str());
+        remove(jobPath.c_str());
+        return false;
+    }
+
+    fprintf(file, "{\n  \"job\": ");
+    writeString(file, jobPath.c_str());
+    fprintf(file, ",\n  \"success\": %s,\n  \"error\": ", result.success ? "true" : "false");
+    writeString(file, result.error.c_str());
+    fprintf(file, ",\n");
+    writeStringList(file, "shader_errors", result.errors);
+    fprintf(file, ",\n");
+    writeStringList(file, "outputs", result.outputs);
+    fprintf(file, ",\n  \"load_ms\": %.2f,\n", result.loadMS);
+    fprintf(file, "  \"compile_ms\": %.2f,\n", result.compileMS);
+    fprintf(file, "  \"render_ms\": %.2f\n}\n", result.renderMS);
+    fclose(file);
+
+    remove(jobPath.c_str());
+    printf("job %s %s, result written to %s\n", jobPath.c_str(), result.success ? "done" : "failed",
+           resultPath.c_str());
+    return true;
+}
+
+bool isRenderServerStopped(const char* directory)
+{
+    const std::string stopPath = std::string(directory) + "/stop";
+    FILE* file = fopen(stopPath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    fclose(file);
+    remove(stopPath.c_str());
+    return true;
+}
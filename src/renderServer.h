@@ -0,0 +1,45 @@
+#pragma once
+
+#include "watcher.h"
+
+#include <string>
+#include <vector>
+
+// --serve keeps one context alive and renders the jobs dropped in a spool directory, the oldest name first. A job is
+// a text file with the .job extension, written elsewhere then moved in the directory so it's never read partially:
+//   shader path/to/shader.glsl
+//   texture0 [2d:linear:repeat] path/to/texture.png
+//   size 512x288
+//   time 0 1.5 3
+//   output path/to/image_%d.png
+// relative paths are relative to the spool directory, %d in the output is replaced by the index of the time. Once
+// done, the job file is removed and name.result.json is written next to it. A file named stop ends the server
+struct RenderJob {
+    std::string path;    // job file
+    WatchFileList files; // shader and textures, loaded like the watched files
+    int width = 512;
+    int height = 512;
+    std::vector<float> times;
+    std::string output;
+};
+
+struct RenderJobResult {
+    bool success = false;
+    std::string error;               // why the job failed
+    std::vector<std::string> errors; // shader compile errors
+    std::vector<std::string> outputs;
+    double loadMS = 0.0;
+    double compileMS = 0.0;
+    double renderMS = 0.0;
+};
+
+// path of the next job to process, returns false if there is none
+bool findRenderJob(const char* directory, std::string& jobPath);
+// parse the job file, returns false with the reason if it's malformed
+bool readRenderJob(const char* directory, const std::string& jobPath, RenderJob& job, std::string& error);
+// output path of the image for the given time index
+std::string getRenderJobOutput(const RenderJob& job, size_t timeIndex);
+// write the result manifest and remove the job file
+bool finishRenderJob(const std::string& jobPath, const RenderJobResult& result);
+// returns true once if the stop file exists, the file is removed
+bool isRenderServerStopped(const char* directory);
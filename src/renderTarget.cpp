@@ -0,0 +1,186 @@
+#include "renderTarget.h"
+#include "glState.h"
+
+#include <stdio.h>
+
+namespace {
+
+// the fullscreen triangle is generated from gl_VertexID so the present pass does not need any vertex buffer
+const char* const PresentVertex = R"(
+#version 330
+
+void main() {
+  vec2 vp = vec2(gl_VertexID == 0 ? 4.0 : -1.0, gl_VertexID == 1 ? 4.0 : -1.0);
+  gl_Position = vec4(vp, 0.0, 1.0);
+}
+)";
+
+const char* const PresentFragment = R"(
+#version 330
+
+uniform sampler2D image;
+uniform vec2 outputSize;
+uniform vec4 region;
+out vec4 frag_colour;
+
+void main() {
+  frag_colour = texture(image, region.xy + gl_FragCoord.xy / outputSize * region.zw);
+}
+)";
+
+struct Present {
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLint imageLocation = -1;
+    GLint outputSizeLocation = -1;
+    GLint regionLocation = -1;
+};
+Present gPresent;
+
+GLuint compileFullscreenShader(const char* shaderText, GLenum shaderType)
+{
+    GLuint shader = glCreateShader(shaderType);
+    glShaderSource(shader, 1, &shaderText, NULL);
+    glCompileShader(shader);
+    GLint status;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (!status) {
+        char infoLog[1024];
+        glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+        printf("fails to compile fullscreen shader:\n%s", infoLog);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+} // namespace
+
+bool createRenderTarget(RenderTarget& target, int width, int height, GLenum internalFormat, int attachmentCount)
+{
+    target.width = width;
+    target.height = height;
+    target.internalFormat = internalFormat;
+    target.attachmentCount = attachmentCount;
+
+    glGenFramebuffers(1, &target.framebuffer);
+    bindFramebuffer(target.framebuffer);
+
+    GLenum drawBuffers[2];
+    for (int i = 0; i < attachmentCount; i++) {
+        GLuint& texture = target.textures[i];
+        glGenTextures(1, &texture);
+        bindTexture(0, GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GLint(internalFormat), width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+
+        drawBuffers[i] = GL_COLOR_ATTACHMENT0 + GLenum(i);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[i], GL_TEXTURE_2D, texture, 0);
+    }
+    glDrawBuffers(attachmentCount, drawBuffers);
+
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        printf("framebuffer %dx%d incomplete (0x%x)\n", width, height, status);
+        bindFramebuffer(0);
+        destroyRenderTarget(target);
+        return false;
+    }
+
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    bindFramebuffer(0);
+    return true;
+}
+
+void destroyRenderTarget(RenderTarget& target)
+{
+    if (target.framebuffer) {
+        deleteFramebuffer(target.framebuffer);
+    }
+    for (int i = 0; i < target.attachmentCount; i++) {
+        deleteTexture(target.textures[i]);
+        target.textures[i] = 0;
+    }
+    target.framebuffer = 0;
+    target.attachmentCount = 0;
+    target.width = 0;
+    target.height = 0;
+}
+
+GLuint createFullscreenProgram(const char* fragmentShader)
+{
+    GLuint vs = compileFullscreenShader(PresentVertex, GL_VERTEX_SHADER);
+    GLuint fs = compileFullscreenShader(fragmentShader, GL_FRAGMENT_SHADER);
+    if (!vs || !fs) {
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint status;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (!status) {
+        printf("fails to link fullscreen program\n");
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void drawFullscreenTriangle()
+{
+    bindVertexArray(gPresent.vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+bool initPresent()
+{
+    gPresent.program = createFullscreenProgram(PresentFragment);
+    if (!gPresent.program) {
+        return false;
+    }
+
+    gPresent.imageLocation = glGetUniformLocation(gPresent.program, "image");
+    gPresent.outputSizeLocation = glGetUniformLocation(gPresent.program, "outputSize");
+    gPresent.regionLocation = glGetUniformLocation(gPresent.program, "region");
+
+    // core profile needs a vao bound even without attributes
+    glGenVertexArrays(1, &gPresent.vao);
+    return true;
+}
+
+void presentTexture(GLuint texture, int width, int height)
+{
+    const float region[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    presentTextureRegion(texture, width, height, region);
+}
+
+void presentTextureRegion(GLuint texture, int width, int height, const float region[4])
+{
+    useProgram(gPresent.program);
+    bindTexture(0, GL_TEXTURE_2D, texture);
+    glUniform1i(gPresent.imageLocation, 0);
+    glUniform2f(gPresent.outputSizeLocation, float(width), float(height));
+    glUniform4f(gPresent.regionLocation, region[0], region[1], region[2], region[3]);
+    drawFullscreenTriangle();
+}
+
+void cleanupPresent()
+{
+    if (gPresent.program) {
+        deleteProgram(gPresent.program);
+        deleteVertexArray(gPresent.vao);
+    }
+    gPresent = Present();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// offscreen framebuffer with up to 2 color attachments of the same format
+struct RenderTarget {
+    GLuint framebuffer = 0;
+    GLuint textures[2] = {0, 0};
+    int attachmentCount = 0;
+    GLenum internalFormat = GL_RGBA8;
+    int width = 0;
+    int height = 0;
+};
+
+bool createRenderTarget(RenderTarget& target, int width, int height, GLenum internalFormat, int attachmentCount = 1);
+void destroyRenderTarget(RenderTarget& target);
+
+// program made of the given fragment shader and a fullscreen triangle vertex shader, 0 if it fails to build
+GLuint createFullscreenProgram(const char* fragmentShader);
+// needs initPresent for the vertex array
+void drawFullscreenTriangle();
+
+// draw a texture with a fullscreen triangle in the current framebuffer
+bool initPresent();
+void presentTexture(GLuint texture, int width, int height);
+// only the part of the texture given in texture coordinates (x, y, width, height) stretched to the output
+void presentTextureRegion(GLuint texture, int width, int height, const float region[4]);
+void cleanupPresent();
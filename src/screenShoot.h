@@ -1,3 +1,3 @@
 #pragma once
-struct Application;
-bool screenShoot(Application* app, const char* filename);
+// save the first color attachment of the bound framebuffer
+bool saveFramebuffer(const char* filename, int width, int height);
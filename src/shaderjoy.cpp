@@ -1,20 +1,36 @@
 #include "Application.h"
+#include "Channel.h"
 #include "ProgramDescription.h"
 #include "UniformList.h"
+#include "accumulation.h"
+#include "benchmark.h"
+#include "compressedTexture.h"
+#include "glState.h"
 #include "glad/glad.h"
+#include "hash.h"
+#include "headless.h"
+#include "renderServer.h"
+#include "renderTarget.h"
 #include "screenShoot.h"
+#include "textureCache.h"
+#include "textureUpload.h"
 #include "timer.h"
+#include "uniformBuffer.h"
 #include "watcher.h"
 #include "window.h"
 
 #include <sys/stat.h>
 
 #include <GLFW/glfw3.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <atomic>
+#include <functional>
+#include <map>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -54,6 +70,9 @@ void dumpFileEntry(const WatchFile& fileEntry)
         case Texture::RGB:
             printf("RGB:");
             break;
+        case Texture::RG:
+            printf("RG:");
+            break;
         case Texture::R:
             printf("R:");
             break;
@@ -95,6 +114,7 @@ float clamp(const float v, const float min, const float max)
 void initIMGUI(GLFWwindow* window);
 void drawIMGUI();
 void cleanupIMGUI();
+void processIMGUIInput(const InputEvent& event);
 
 void debugShader(const char* shaderText, const char* errorLog, const char* preShaderText, const char* postShaderText,
                  char* resultShaderWithErrors, size_t& resultShaderWithErrorsSize, char* resultErrors,
@@ -127,18 +147,130 @@ void mainImage( out vec4 fragColor, in vec2 fragCoord )
 
 const char* defaultTemplatePreFragment = nullptr;
 
+// with the checkerboard rendering (see checkerboard.h) the shader is drawn in a half width target, fragCoord is
+// remapped to the pixel of the full frame so the shader does not need to know about it
 const char* defaultTemplatePostFragment = R"(
+uniform int shaderjoyCheckerboard; // 0 all the pixels, 1 + phase for one pixel out of two
+
+void main() {
+
+  vec2 fragCoord = gl_FragCoord.xy;
+  if (shaderjoyCheckerboard != 0) {
+    int phase = shaderjoyCheckerboard - 1;
+    fragCoord.x = floor(fragCoord.x) * 2.0 + float((int(fragCoord.y) + phase) & 1) + 0.5;
+  }
+  vec4 color;
+  mainImage(color, fragCoord);
+  frag_colour = color;
+}
+
+)";
+
+const char* accumulationTemplatePostFragment = R"(
 void main() {
 
   vec4 color;
   mainImage(color, gl_FragCoord.xy);
   frag_colour = color;
+  frag_moment = vec4(color.rgb * color.rgb, 1.0);
 }
 
 )";
 
+// indexed by BuiltinUniform
+const char* const BuiltinUniformNames[BUILTIN_UNIFORM_COUNT] = {
+    "iMouse", "iResolution", "iTime", "iTimeDelta", "iFrame", "iFrameRate", "iSampleCount", "iChannelResolution"};
+
+// declarations used when the shader declares some of the built-in uniforms itself
+const char* const BuiltinUniformDeclarations[BUILTIN_UNIFORM_COUNT] = {
+    "uniform vec4 iMouse;\n",     "uniform vec3 iResolution;\n", "uniform float iTime;\n",
+    "uniform float iTimeDelta;\n", "uniform int iFrame;\n",        "uniform float iFrameRate;\n",
+    "uniform int iSampleCount;\n", "uniform vec3 iChannelResolution[4];\n"};
+
+// must match the UniformBlock structure
+const char* const BuiltinUniformBlock = R"(layout(std140) uniform ShaderJoyInputs {
+  vec4 iMouse;
+  vec3 iResolution;
+  float iTime;
+  float iTimeDelta;
+  int iFrame;
+  float iFrameRate;
+  int iSampleCount;
+  vec3 iChannelResolution[4];
+};
+)";
+
+struct BuiltinScan {
+    unsigned int declared = 0;   // one bit per BuiltinUniform declared as uniform by the shader
+    unsigned int referenced = 0; // one bit per BuiltinUniform that appears in the shader
+};
+
+// find the built-in uniforms used by the shader text, comments are skipped
+BuiltinScan scanBuiltinUniforms(const char* shader, const size_t size)
+{
+    BuiltinScan scan;
+    bool inUniformDeclaration = false; // between the 'uniform' keyword and ';'
+    size_t i = 0;
+    while (i < size) {
+        const char c = shader[i];
+        if (c == '/' && i + 1 < size && shader[i + 1] == '/') {
+            while (i < size && shader[i] != '\n') {
+                i++;
+            }
+        } else if (c == '/' && i + 1 < size && shader[i + 1] == '*') {
+            i += 2;
+            while (i + 1 < size && !(shader[i] == '*' && shader[i + 1] == '/')) {
+                i++;
+            }
+            i += 2;
+        } else if (isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            const char* identifier = shader + i;
+            while (i < size && (isalnum(static_cast<unsigned char>(shader[i])) || shader[i] == '_')) {
+                i++;
+            }
+            const size_t length = size_t(shader + i - identifier);
+            if (length == 7 && strncmp(identifier, "uniform", 7) == 0) {
+                inUniformDeclaration = true;
+            }
+            for (int builtin = 0; builtin < BUILTIN_UNIFORM_COUNT; builtin++) {
+                const char* name = BuiltinUniformNames[builtin];
+                if (strlen(name) == length && strncmp(identifier, name, length) == 0) {
+                    scan.referenced |= 1u << builtin;
+                    if (inUniformDeclaration) {
+                        scan.declared |= 1u << builtin;
+                    }
+                }
+            }
+        } else {
+            if (c == ';') {
+                inUniformDeclaration = false;
+            }
+            i++;
+        }
+    }
+    return scan;
+}
+
+// built-in uniforms are grouped in a uniform block unless the shader declares some of them itself. In this case
+// the template declares the remaining ones as regular uniforms
+std::string createBuiltinDeclarations(const unsigned int declaredBuiltins)
+{
+    if (!declaredBuiltins) {
+        return BuiltinUniformBlock;
+    }
+
+    std::string declarations;
+    for (int builtin = 0; builtin < BUILTIN_UNIFORM_COUNT; builtin++) {
+        if (!(declaredBuiltins & (1u << builtin))) {
+            declarations += BuiltinUniformDeclarations[builtin];
+        }
+    }
+    return declarations;
+}
+
 bool compileShader(const char* shaderText, GLenum shaderType, GLuint& shader,
-                   ShaderCompileReport* shaderReport = nullptr)
+                   ShaderCompileReport* shaderReport = nullptr, const char* preShaderText = nullptr,
+                   const char* postShaderText = nullptr)
 {
     // printf("real shader:\n%s\n", shaderText);
     // buffer twice the shader size
@@ -171,8 +303,8 @@ bool compileShader(const char* shaderText, GLenum shaderType, GLuint& shader,
     }
 
     if (shaderReport) {
-        createShaderReport(shaderText, shaderResult ? nullptr : shaderReport->errorBuffer.data(),
-                           defaultTemplatePreFragment, defaultTemplatePostFragment, shaderReport);
+        createShaderReport(shaderText, shaderResult ? nullptr : shaderReport->errorBuffer.data(), preShaderText,
+                           postShaderText, shaderReport);
 
         if (!shaderResult) {
 
@@ -264,12 +396,16 @@ int getUniformIndex(const ProgramDescription* programDescription, const char* na
 bool compileProgram(const GLuint vs, const char* shader, const size_t size, GLuint& fs, GLuint& program,
                     ShaderCompileReport& shaderReport)
 {
+    const BuiltinScan scan = scanBuiltinUniforms(shader, size);
+    const std::string preFragment =
+        std::string(defaultTemplatePreFragment) + createBuiltinDeclarations(scan.declared);
+
     std::vector<char>& fullShader = shaderReport.shaderBuffer;
-    fullShader.resize(size + 1024);
+    fullShader.resize(preFragment.size() + size + strlen(defaultTemplatePostFragment) + 1);
     size_t index = 0;
     size_t fragmentSize = 0;
-    fragmentSize = strlen(defaultTemplatePreFragment);
-    memcpy(fullShader.data() + index, defaultTemplatePreFragment, fragmentSize);
+    fragmentSize = preFragment.size();
+    memcpy(fullShader.data() + index, preFragment.c_str(), fragmentSize);
     index += fragmentSize;
     memcpy(fullShader.data() + index, shader, size);
     index += size;
@@ -280,7 +416,8 @@ bool compileProgram(const GLuint vs, const char* shader, const size_t size, GLui
     fullShader.resize(index);
 
     GLuint newFS = glCreateShader(GL_FRAGMENT_SHADER);
-    if (!compileShader(fullShader.data(), GL_FRAGMENT_SHADER, newFS, &shaderReport)) {
+    if (!compileShader(fullShader.data(), GL_FRAGMENT_SHADER, newFS, &shaderReport, preFragment.c_str(),
+                       defaultTemplatePostFragment)) {
         glDeleteShader(newFS);
         return false;
     }
@@ -297,9 +434,24 @@ bool compileProgram(const GLuint vs, const char* shader, const size_t size, GLui
         return false;
     }
 
+    // samplers and the uniform block binding do not change for the lifetime of the program
+    useProgram(newProgram);
+    for (int i = 0; i < 4; i++) {
+        char tmp[32];
+        sprintf(tmp, "iChannel%d", i);
+        const GLint location = glGetUniformLocation(newProgram, tmp);
+        if (location != -1) {
+            glUniform1i(location, i);
+        }
+    }
+    const GLuint blockIndex = glGetUniformBlockIndex(newProgram, "ShaderJoyInputs");
+    if (blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(newProgram, blockIndex, UniformBlockBinding);
+    }
+
     // success and an older program exist, so delete it
     if (program != -1U) {
-        glDeleteProgram(program);
+        deleteProgram(program);
         glDeleteShader(fs);
     }
 
@@ -309,113 +461,41 @@ bool compileProgram(const GLuint vs, const char* shader, const size_t size, GLui
     return true;
 }
 
-void updateTexture(GLuint& textureID, float* size, const Texture& texture)
-{
-    if (textureID != ~0x0u) {
-        glDeleteTextures(1, &textureID);
-    }
-
-    GLint wrap = texture.wrap == Texture::REPEAT ? GL_REPEAT : GL_CLAMP_TO_EDGE;
-    GLint minFilter;
-    GLint magFilter;
-    GLint format;
-    GLenum type = GL_UNSIGNED_BYTE;
-
-    switch (texture.format) {
-    case Texture::RGB:
-        format = GL_RGB;
-        break;
-    case Texture::RGBA:
-        format = GL_RGBA;
-        break;
-    case Texture::R:
-        format = GL_RED;
-        break;
-    }
-
-    switch (texture.filter) {
-    case Texture::LINEAR:
-        magFilter = minFilter = GL_LINEAR;
-        break;
-    case Texture::LINEAR_MIPMAP_LINEAR:
-        minFilter = GL_LINEAR_MIPMAP_LINEAR;
-        magFilter = GL_LINEAR;
-        break;
-    case Texture::NEAREST:
-        magFilter = minFilter = GL_NEAREST;
-        break;
-    }
-
-    size[0] = texture.size[0];
-    size[1] = texture.size[1];
-    size[2] = texture.size[2];
-
-    glGenTextures(1, &textureID);
-
-    if (texture.target == Texture::TEXTURE_2D) {
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
-
-        // if ()
-        glPixelStorei(GL_UNPACK_ALIGNMENT, texture.size[0] % 4 ? 1 : 4);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, texture.size[0], texture.size[1], 0, GLenum(format), type,
-                     texture.data.data());
-
-        if (minFilter == GL_LINEAR_MIPMAP_LINEAR) {
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-
-    } else {
-        glBindTexture(GL_TEXTURE_3D, textureID);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, wrap);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, wrap);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, wrap);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, minFilter);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, magFilter);
-
-        glTexImage3D(GL_TEXTURE_3D, 0, format, texture.size[0], texture.size[1], texture.size[2], 0, GLenum(format),
-                     type, texture.data.data());
-
-        if (minFilter == GL_LINEAR_MIPMAP_LINEAR) {
-            glGenerateMipmap(GL_TEXTURE_3D);
-        }
-    }
-}
-
-void getUniformList(const ProgramDescription* description, UniformList& uniforms)
+void getUniformList(const ProgramDescription* description, const char* shader, const size_t size,
+                    UniformList& uniforms)
 {
     uniforms.iMouseLocation = getUniformLocation(description, "iMouse");
     uniforms.iTimeLocation = getUniformLocation(description, "iTime");
     uniforms.iResolutionLocation = getUniformLocation(description, "iResolution");
     uniforms.iTimeDeltaLocation = getUniformLocation(description, "iTimeDelta");
     uniforms.iFrameLocation = getUniformLocation(description, "iFrame");
+    uniforms.iSampleCountLocation = getUniformLocation(description, "iSampleCount");
+    uniforms.iFrameRateLocation = getUniformLocation(description, "iFrameRate");
 
-    for (int i = 0; i < 4; i++) {
-        char tmp[32];
-        sprintf(tmp, "iChannel%d", i);
-        uniforms.iChannelLocation[i] = getUniformLocation(description, tmp);
-    }
     uniforms.iChannelResolutionLocation = getUniformLocation(description, "iChannelResolution");
+    uniforms.checkerboardLocation = getUniformLocation(description, "shaderjoyCheckerboard");
+
+    // only active uniforms have a location, so a shader that does not read any time uniform gives the same
+    // image until one of its inputs changes
+    uniforms.usesTime = uniforms.iTimeLocation != -1 || uniforms.iTimeDeltaLocation != -1 ||
+                        uniforms.iFrameLocation != -1 || uniforms.iFrameRateLocation != -1;
+    uniforms.usesMouse = uniforms.iMouseLocation != -1;
+
+    // members of a std140 block are all active, so for the uniform block we rely on the shader text instead
+    const BuiltinScan scan = scanBuiltinUniforms(shader, size);
+    uniforms.useUniformBlock = !scan.declared;
+    if (uniforms.useUniformBlock) {
+        const unsigned int timeBuiltins = (1u << ITIME) | (1u << ITIMEDELTA) | (1u << IFRAME) | (1u << IFRAMERATE);
+        uniforms.usesTime = (scan.referenced & timeBuiltins) != 0;
+        uniforms.usesMouse = (scan.referenced & (1u << IMOUSE)) != 0;
+    }
 }
 
 //#define DISPLAY_UNIFORM
 
-void updateUniforms(UniformList uniforms)
+// legacy path used when the shader declares some built-in uniforms itself
+void updateUniforms(const UniformList& uniforms)
 {
-    // iChannels
-    for (int i = 0; i < 4; i++) {
-        if (uniforms.iChannelLocation[i] != -1) {
-#ifdef DISPLAY_UNIFORM
-            char tmp[32];
-            sprintf(tmp, "iChannel%d", i);
-            printf("%s %d: %d\n", tmp, uniforms.iChannelLocation[i], uniforms.iChannel[i]);
-#endif
-            glUniform1iv(uniforms.iChannelLocation[i], 1, &uniforms.iChannel[i]);
-        }
-    }
     if (uniforms.iChannelResolutionLocation != -1) {
 #ifdef DISPLAY_UNIFORM
         printf("iChannelResolution %d: %f %f %f\n                    %f %f %f\n                    %f %f %f\n          "
@@ -469,124 +549,122 @@ void updateUniforms(UniformList uniforms)
 #endif
         glUniform1i(uniforms.iFrameLocation, uniforms.iFrame);
     }
+
+    if (uniforms.iSampleCountLocation != -1) {
+#ifdef DISPLAY_UNIFORM
+        printf("iSampleCount %d\n", uniforms.iSampleCount);
+#endif
+        glUniform1i(uniforms.iSampleCountLocation, uniforms.iSampleCount);
+    }
+
+    if (uniforms.iFrameRateLocation != -1) {
+#ifdef DISPLAY_UNIFORM
+        printf("iFrameRate %f\n", uniforms.iFrameRate);
+#endif
+        glUniform1f(uniforms.iFrameRateLocation, uniforms.iFrameRate);
+    }
 }
 
 void frameIMGUI(Application* app, const UniformList& uniformList);
 
-void drawFrame() {}
-
-void usage()
+// without samplers each channel samples its texture with the settings it was loaded with
+void drawFrame(GLuint program, GLuint vao, const Channel* channels, const ChannelSamplers* samplers,
+               const UniformList& uniformList, UniformBuffer& uniformBuffer)
 {
-    printf("run shaderjoy with only one shader file\n");
-    printf("shaderjoy [--save-frame] shader-file.glsl\n");
-    printf("\nrun shaderjoy with texture:\n");
-    printf("shaderjoy --texture0 [2d:linear:repeat] texture.png fragment.glsl\n");
-    printf("shaderjoy --texture0 [3d:linear:repeat:sizex:sizey:sizez] texture.data fragment.glsl\n");
-    printf("\nto report issue: https://github.com/cedricpinson/shaderjoy/issues\n");
-}
+    setCapability(GL_DEPTH_TEST, false);
 
-bool parseTextureBlock(const char** argv, int i, Texture& texture)
-{
-    // --texture0 [2d:linear:repeat] filename
-    // --texture0 [3d:linear:repeat:sizex:sizey:sizez] filename
-    const char* endPtr = strchr(argv[i], ']');
-    const char* targetStr = &argv[i][1];
-    const char* wrapStr;
-    const char* filterStr;
-    const char* sizexStr;
-    const char* sizeyStr;
-    const char* sizezStr;
-
-    if (strncmp(targetStr, "2d", 2) == 0) {
-        texture.target = Texture::TEXTURE_2D;
-    } else if (strncmp(targetStr, "3d", 2) == 0) {
-        texture.target = Texture::TEXTURE_3D;
-    } else {
-        printf("malformed texture description '%s', it should look like [2d:linear:repeat]\n", argv[i]);
-        return false;
-    }
+    useProgram(program);
 
-    filterStr = targetStr + 3;
-    if (strncmp(filterStr, "linear", 6) == 0) {
-        texture.filter = Texture::LINEAR;
-        wrapStr = filterStr + 7;
-    } else if (strncmp(filterStr, "nearest", 7) == 0) {
-        texture.filter = Texture::NEAREST;
-        wrapStr = filterStr + 8;
-    } else if (strncmp(filterStr, "linear_mipmap_linear", 20) == 0) {
-        texture.filter = Texture::LINEAR_MIPMAP_LINEAR;
-        wrapStr = filterStr + 21;
-    } else {
-        printf("malformed texture description '%s', it should look like [2d:linear:repeat]\n", argv[i]);
-        return false;
+    // 3d textures must be bound on GL_TEXTURE_3D or the sampler3D reads an incomplete texture
+    for (int channelIndex = 0; channelIndex < 4; channelIndex++) {
+        const Channel& channel = channels[samplers ? getChannelSource(*samplers, channelIndex) : channelIndex];
+        if (channel.texture != ~0x0u) {
+            bindTexture(channelIndex, channel.target, channel.texture);
+            bindSampler(channelIndex, samplers ? getChannelSampler(*samplers, channelIndex) : 0);
+        }
     }
 
-    if (strncmp(wrapStr, "repeat", 6) == 0) {
-        texture.wrap = Texture::REPEAT;
-        sizexStr = wrapStr + 7;
-    } else if (strncmp(wrapStr, "clamp", 5) == 0) {
-        texture.wrap = Texture::CLAMP;
-        sizexStr = wrapStr + 6;
+    if (uniformList.useUniformBlock) {
+        updateUniformBuffer(uniformBuffer, uniformList);
     } else {
-        printf("malformed texture description '%s', it should look like [2d:linear:repeat]\n", argv[i]);
-        return false;
+        updateUniforms(uniformList);
+    }
+    if (uniformList.checkerboardLocation != -1) {
+        glUniform1i(uniformList.checkerboardLocation, uniformList.checkerboard);
     }
 
-    // if it's a 3d texture we need to parse the size
-    if (texture.target == Texture::TEXTURE_3D) {
-        const char* endSizeX = strchr(sizexStr, ':');
-        if (endSizeX > endPtr) {
-            printf("malformed texture description '%s', it should look like "
-                   "[3d:linear:repeat:sizex:sizey:sizez]\n",
-                   argv[i]);
-            return false;
-        }
-        char sizeTmp[16];
-        size_t sizeStr;
-        sizeStr = size_t(endSizeX - sizexStr);
-        memcpy(sizeTmp, sizexStr, sizeStr);
-        sizeTmp[sizeStr] = 0;
-        texture.size[0] = atoi(sizeTmp);
-
-        sizeyStr = endSizeX + 1;
-        const char* endSizeY = strchr(sizeyStr, ':');
-        if (endSizeY > endPtr) {
-            printf("malformed texture description '%s', it should look like "
-                   "[3d:linear:repeat:sizex:sizey:sizez]\n",
-                   argv[i]);
-            return false;
+    bindVertexArray(vao);
+    // draw points 0-3 from the currently bound VAO with current in-use shader
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // a sampler left bound would override the parameters of the textures read by the other passes on these units
+    if (samplers) {
+        for (int channelIndex = 0; channelIndex < 4; channelIndex++) {
+            bindSampler(channelIndex, 0);
         }
-        sizeStr = size_t(endSizeY - sizeyStr);
-        memcpy(sizeTmp, sizeyStr, sizeStr);
-        sizeTmp[sizeStr] = 0;
-        texture.size[1] = atoi(sizeTmp);
+    }
+}
 
-        sizezStr = endSizeY + 1;
-        const char* endSizeZ = endPtr;
+void usage()
+{
+    printf("run shaderjoy with only one shader file\n");
+    printf("shaderjoy [--save-frame] shader-file.glsl\n");
+    printf("\nrun shaderjoy accumulating frames (iSampleCount is the number of samples already accumulated):\n");
+    printf("shaderjoy --accumulate [--max-samples N] [--noise-threshold 0.001] shader-file.glsl\n");
+    printf("\npresentation without overlay, for installations or measurements (-1 is adaptive vsync):\n");
+    printf("shaderjoy --presentation [--swap-interval 0|1|-1] [--fullscreen] [--monitor N] [--on-top] "
+           "shader-file.glsl\n");
+    printf("\nrendering while the window is iconified, or unfocused with --throttle-unfocused (stop by default):\n");
+    printf("shaderjoy --hidden-policy stop|full|fps:10|scale:0.25 [--throttle-unfocused] shader-file.glsl\n");
+    printf("\nlimit the frames queued to the gpu to reduce the latency of the mouse:\n");
+    printf("shaderjoy --low-latency shader-file.glsl\n");
+    printf("\nshade half of the pixels each frame and reconstruct the others (toggled with the 'c' key):\n");
+    printf("shaderjoy --checkerboard shader-file.glsl\n");
+    printf("\nrun a heavy shader in tiles spread over several frames:\n");
+    printf("shaderjoy --tiled [--tile-size 256] [--tile-budget ms] [--tile-timeout ms] shader-file.glsl\n");
+    printf("\nbenchmark a shader offscreen and write the frame times in a json file:\n");
+    printf("shaderjoy --benchmark [--size 1920x1080] [--benchmark-warmup seconds] [--benchmark-frames N | "
+           "--benchmark-seconds S] [--benchmark-output file.json] shader-file.glsl\n");
+    printf("\nrender the jobs dropped in a spool directory with one context, see renderServer.h for the job format:\n");
+    printf("shaderjoy --serve spool-directory\n");
+    printf("\nrun shaderjoy with texture:\n");
+    printf("shaderjoy --texture0 [2d:linear:repeat] texture.png fragment.glsl\n");
+    printf("shaderjoy --texture0 [2d:linear:repeat:f32] environment.hdr fragment.glsl\n");
+    printf("shaderjoy --texture0 [3d:linear:repeat:sizex:sizey:sizez:u8|u16|f16|f32] volume.raw fragment.glsl\n");
+    printf("\nkeep the decoded images and their mipmaps in a directory to load them faster the next time:\n");
+    printf("shaderjoy --texture-cache directory --texture0 [2d:linear:repeat] texture.png fragment.glsl\n");
+    printf("\nto report issue: https://github.com/cedricpinson/shaderjoy/issues\n");
+}
 
-        sizeStr = size_t(endSizeZ - sizezStr);
-        memcpy(sizeTmp, sizeyStr, sizeStr);
-        sizeTmp[sizeStr] = 0;
-        texture.size[2] = atoi(sizeTmp);
+// images larger than the driver allows are downscaled on load like with maxsize
+void limitTextureMaxSize(Texture& texture)
+{
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    if (texture.maxSize <= 0 || texture.maxSize > maxTextureSize) {
+        texture.maxSize = maxTextureSize;
     }
+}
 
-    return true;
+// true if the settings of the textures give the same texture from the same file, the sampling can differ
+bool hasSameTextureContent(const Texture& a, const Texture& b)
+{
+    return a.target == b.target && a.type == b.type && a.fullPrecision == b.fullPrecision && a.maxSize == b.maxSize &&
+           a.size[0] == b.size[0] && a.size[1] == b.size[1] && a.size[2] == b.size[2];
 }
 
-std::string createFragmentTemplate(const WatchFileList& fileList)
+// samplers gives the channels sharing the texture of another channel, they are not in the file list
+std::string createFragmentTemplate(const WatchFileList& fileList, const ChannelSamplers* samplers, bool accumulation)
 {
     std::string fragmentTemplate = R"(
 #version 330
 
-out vec4 frag_colour;
-uniform vec4 iMouse;
-uniform vec3 iResolution;
-uniform float iTime;
-uniform float iTimeDelta;
-uniform int iFrame;
-uniform float iFrameRate;
-uniform vec3 iChannelResolution[4];
+layout(location = 0) out vec4 frag_colour;
 )";
+    // the squared color is accumulated in a second attachment to estimate the noise
+    if (accumulation) {
+        fragmentTemplate += "layout(location = 1) out vec4 frag_moment;\n";
+    }
     for (auto&& it : fileList) {
         char tmp[128];
         switch (it.type) {
@@ -604,17 +682,307 @@ uniform vec3 iChannelResolution[4];
             break;
         }
     }
+    for (int channel = 0; samplers && channel < 4; channel++) {
+        const int source = samplers->channels[channel].source;
+        for (auto&& it : fileList) {
+            if (source >= 0 && it.type == WatchFile::Type(WatchFile::TEXTURE0 + source)) {
+                char tmp[128];
+                sprintf(tmp, "uniform sampler%s iChannel%d;\n", it.texture.target == Texture::TEXTURE_2D ? "2D" : "3D",
+                        channel);
+                fragmentTemplate += std::string(tmp);
+            }
+        }
+    }
     return fragmentTemplate;
 }
 
+// non interactive runs need all the files before rendering, returns false if they can't be loaded or compiled
+bool waitForFiles(Application& app, const std::function<int()>& processFileChange, const char* mode)
+{
+    const WatchFileList& files = app.watcher._files;
+    std::vector<bool> loaded(files.size(), false);
+    size_t loadedCount = 0;
+    const double loadStart = getTimeInMS();
+    while (loadedCount < files.size()) {
+        const int fileIndex = processFileChange();
+        if (fileIndex >= 0 && !loaded[size_t(fileIndex)]) {
+            loaded[size_t(fileIndex)] = true;
+            loadedCount++;
+        }
+        if (getTimeInMS() - loadStart > 10000.0) {
+            printf("%s: files are not loaded after 10 seconds\n", mode);
+            return false;
+        }
+        sleepInMS(10);
+    }
+    if (!app.shaderReport.compileSuccess) {
+        printf("%s: shader failed to compile\n", mode);
+        return false;
+    }
+    return true;
+}
+
+// wait for the watcher to load all the files then measure the shader
+bool benchmarkShader(Application& app, UniformList& uniformList, const std::function<int()>& processFileChange,
+                     const std::function<void()>& draw)
+{
+    if (!waitForFiles(app, processFileChange, "benchmark")) {
+        return false;
+    }
+
+    const int width = app.benchmark.width;
+    const int height = app.benchmark.height;
+    // use a fixed 60Hz clock so the content of each frame does not depend on the speed of the machine
+    const bool success = runBenchmark(app.benchmark, [&](int frame) {
+        uniformList.iResolution[0] = float(width);
+        uniformList.iResolution[1] = float(height);
+        uniformList.iResolution[2] = float(height) / float(width);
+        uniformList.iFrame = frame;
+        uniformList.iTime = float(frame) / 60.0f;
+        uniformList.iTimeDelta = 1.0f / 60.0f;
+        draw();
+    });
+    if (!success) {
+        return false;
+    }
+
+    const char* shaderPath = "default";
+    uint64_t sourceHash = hashBuffer(defaultFragment, strlen(defaultFragment));
+    app.watcher.lock();
+    for (auto&& file : app.watcher._files) {
+        if (file.type == WatchFile::SHADER) {
+            shaderPath = file.path.c_str();
+            sourceHash = hashBuffer(file.data.data(), file.data.size());
+        }
+    }
+    app.watcher.unlock();
+    return writeBenchmarkReport(app.benchmark, shaderPath, sourceHash);
+}
+
+// render one frame at the given size and time in a framebuffer, no window is displayed
+bool saveFrameOffscreen(Application& app, UniformList& uniformList, const std::function<int()>& processFileChange,
+                        const std::function<void()>& draw, const char* path, int width, int height, float time)
+{
+    if (!waitForFiles(app, processFileChange, "save-frame")) {
+        return false;
+    }
+
+    RenderTarget target;
+    if (!createRenderTarget(target, width, height, GL_RGBA8)) {
+        return false;
+    }
+    glViewport(0, 0, width, height);
+    uniformList.iResolution[0] = float(width);
+    uniformList.iResolution[1] = float(height);
+    uniformList.iResolution[2] = float(height) / float(width);
+    // same clock as the benchmark, 60 frames per second
+    uniformList.iTime = time;
+    uniformList.iTimeDelta = 1.0f / 60.0f;
+    uniformList.iFrame = int(time * 60.0f);
+
+    Accumulation& accumulation = app.accumulation;
+    if (accumulation.enabled) {
+        if (!setupAccumulation(accumulation, width, height)) {
+            destroyRenderTarget(target);
+            return false;
+        }
+        while (!accumulation.converged) {
+            uniformList.iSampleCount = accumulation.sampleCount;
+            beginAccumulationSample(accumulation);
+            draw();
+            endAccumulationSample(accumulation);
+            uniformList.iFrame++;
+        }
+        bindFramebuffer(target.framebuffer);
+        presentTexture(accumulation.target.textures[0], width, height);
+    } else {
+        bindFramebuffer(target.framebuffer);
+        draw();
+    }
+
+    const bool success = saveFramebuffer(path, width, height);
+    if (!success) {
+        printf("fails to write %s\n", path);
+    }
+    bindFramebuffer(0);
+    destroyRenderTarget(target);
+    return success;
+}
+
+// texture shared by the jobs of --serve, reloaded if the file changed
+struct CachedTexture {
+    time_t lastChange = 0;
+    Channel channel;
+    float resolution[3] = {0.0f, 0.0f, 0.0f};
+    int lastJob = 0;
+};
+
+// load, compile and render one job of --serve, the vertex shader, the vao and the textures are kept between jobs
+void runRenderJob(Application& app, RenderJob& job, RenderJobResult& result, int jobIndex, GLuint vs, GLuint& fs,
+                  GLuint& program, GLuint vao, UniformBuffer& uniformBuffer, RenderTarget& target,
+                  std::map<std::string, CachedTexture>& textureCache)
+{
+    double start = getTimeInMS();
+    const WatchFile* shader = nullptr;
+    Channel channels[4];
+    float resolutions[4][3] = {};
+    for (auto&& entry : job.files) {
+        if (entry.type == WatchFile::SHADER) {
+            if (!readShaderFile(entry)) {
+                result.error = "cant read the shader " + entry.path;
+                return;
+            }
+            shader = &entry;
+            continue;
+        }
+
+        limitTextureMaxSize(entry.texture);
+        // every setting read by readTextureFile, a file loaded with other settings is another texture
+        const Texture& settings = entry.texture;
+        char config[128];
+        snprintf(config, sizeof(config), "[%d:%d:%d:%d:%dx%dx%d:%d:%d]", int(settings.target), int(settings.filter),
+                 int(settings.wrap), settings.maxSize, settings.size[0], settings.size[1], settings.size[2],
+                 int(settings.type), int(settings.fullPrecision));
+        CachedTexture& cached = textureCache[entry.path + config];
+        struct stat st;
+        const time_t lastChange = stat(entry.path.c_str(), &st) == 0 ? st.st_mtime : 0;
+        if (cached.channel.texture == ~0x0u || cached.lastChange != lastChange) {
+            if (!readTextureFile(entry, app.textureCacheDirectory)) {
+                result.error = "cant read the texture " + entry.path;
+                return;
+            }
+            const int unit = entry.type - int(WatchFile::TEXTURE0);
+            updateTexture(cached.channel, unit, cached.resolution, entry.texture);
+            releaseTextureData(entry.texture);
+            cached.lastChange = lastChange;
+        }
+        cached.lastJob = jobIndex;
+        const int unit = entry.type - int(WatchFile::TEXTURE0);
+        channels[unit] = cached.channel;
+        memcpy(resolutions[unit], cached.resolution, sizeof(cached.resolution));
+    }
+    result.loadMS = getTimeInMS() - start;
+
+    start = getTimeInMS();
+    const char* shaderText = reinterpret_cast<const char*>(shader->data.data());
+    if (!compileProgram(vs, shaderText, shader->data.size(), fs, program, app.shaderReport)) {
+        result.error = "shader failed to compile";
+        for (auto&& line : app.shaderReport.errorLines) {
+            result.errors.push_back(std::to_string(line.lineNumber) + ": " + std::string(line.text, line.size));
+        }
+        // the info log is kept as is when its format is not recognized
+        const std::vector<char>& log = app.shaderReport.errorBuffer;
+        if (result.errors.empty() && !log.empty()) {
+            result.errors.push_back(std::string(log.data(), strnlen(log.data(), log.size())));
+        }
+        return;
+    }
+    ProgramDescription programDescription;
+    getProgramDescription(program, programDescription);
+    UniformList uniformList;
+    getUniformList(&programDescription, shaderText, shader->data.size(), uniformList);
+    memcpy(uniformList.iChannelResolution, resolutions, sizeof(resolutions));
+    result.compileMS = getTimeInMS() - start;
+
+    start = getTimeInMS();
+    if (target.width != job.width || target.height != job.height) {
+        destroyRenderTarget(target);
+        if (!createRenderTarget(target, job.width, job.height, GL_RGBA8)) {
+            result.error = "cant create the framebuffer";
+            return;
+        }
+    }
+    bindFramebuffer(target.framebuffer);
+    glViewport(0, 0, job.width, job.height);
+    // a channel not used by this job must not show the texture of a previous job
+    for (int unit = 0; unit < 4; unit++) {
+        if (channels[unit].texture == ~0x0u) {
+            bindTexture(unit, GL_TEXTURE_2D, 0);
+        }
+    }
+    uniformList.iResolution[0] = float(job.width);
+    uniformList.iResolution[1] = float(job.height);
+    uniformList.iResolution[2] = float(job.height) / float(job.width);
+    for (size_t i = 0; i < job.times.size(); i++) {
+        // same clock as --save-frame
+        uniformList.iTime = job.times[i];
+        uniformList.iTimeDelta = 1.0f / 60.0f;
+        uniformList.iFrame = int(job.times[i] * 60.0f);
+        drawFrame(program, vao, channels, nullptr, uniformList, uniformBuffer);
+
+        const std::string output = getRenderJobOutput(job, i);
+        if (!saveFramebuffer(output.c_str(), job.width, job.height)) {
+            result.error = "cant write " + output;
+            break;
+        }
+        result.outputs.push_back(output);
+    }
+    bindFramebuffer(0);
+    result.renderMS = getTimeInMS() - start;
+    result.success = result.error.empty();
+}
+
+// process the jobs of the spool directory until the stop file is created
+void serveSpoolDirectory(Application& app, const char* directory, GLuint vs, GLuint& fs, GLuint& program, GLuint vao,
+                         UniformBuffer& uniformBuffer)
+{
+    printf("serving the jobs of %s, create the file %s/stop to quit\n", directory, directory);
+    const size_t MaxCachedTextures = 64;
+    RenderTarget target;
+    std::map<std::string, CachedTexture> textureCache;
+    std::string fragmentTemplate;
+    int jobIndex = 0;
+    while (!isRenderServerStopped(directory)) {
+        std::string jobPath;
+        if (!findRenderJob(directory, jobPath)) {
+            sleepInMS(50);
+            continue;
+        }
+
+        jobIndex++;
+        RenderJob job;
+        RenderJobResult result;
+        if (readRenderJob(directory, jobPath, job, result.error)) {
+            // the samplers declared by the template depend on the channels of the job
+            fragmentTemplate = createFragmentTemplate(job.files, nullptr, false);
+            defaultTemplatePreFragment = fragmentTemplate.c_str();
+            runRenderJob(app, job, result, jobIndex, vs, fs, program, vao, uniformBuffer, target, textureCache);
+        }
+        finishRenderJob(jobPath, result);
+
+        // only the textures of the last job are kept when the cache is full
+        if (textureCache.size() > MaxCachedTextures) {
+            for (auto it = textureCache.begin(); it != textureCache.end();) {
+                if (it->second.lastJob != jobIndex) {
+                    deleteTexture(it->second.channel.texture);
+                    it = textureCache.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    for (auto&& entry : textureCache) {
+        deleteTexture(entry.second.channel.texture);
+    }
+    destroyRenderTarget(target);
+}
+
 int main(int argc, const char** argv)
 {
     (void)argc;
     (void)argv;
     const char* const saveImagePath = "./shaderjoy_frame.png";
+    const int saveFrameDefaultSamples = 256;
+    const int benchmarkDefaultFrames = 500;
     bool executeOneFrame = false;
+    const char* serveDirectory = nullptr;
+    float saveFrameTime = 0.0f;
+    WindowStyle windowStyle = REGULAR;
     initTime();
     Application app;
+    int exitCode = 0;
 
     if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
         usage();
@@ -629,9 +997,141 @@ int main(int argc, const char** argv)
                 executeOneFrame = true;
                 printf("will execute and save one frame [%s]\n", saveImagePath);
 
+            } else if (strcmp(argv[i], "--serve") == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse --serve, expect a spool directory\n");
+                    return 1;
+                }
+                serveDirectory = argv[++i];
+            } else if (strcmp(argv[i], "--time") == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse --time, expect a time in seconds\n");
+                    return 1;
+                }
+                saveFrameTime = float(atof(argv[++i]));
+            } else if (strcmp(argv[i], "--size") == 0) {
+                if (i + 1 >= argc || sscanf(argv[i + 1], "%dx%d", &app.width, &app.height) != 2) {
+                    printf("not enough argument to parse --size, expect a size like 1920x1080\n");
+                    return 1;
+                }
+                i++;
+            } else if (strcmp(argv[i], "--benchmark") == 0) {
+                app.benchmark.enabled = true;
+            } else if (strncmp(argv[i], "--benchmark-", 12) == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse %s\n", argv[i]);
+                    return 1;
+                }
+                const char* option = argv[i] + 12;
+                const char* value = argv[++i];
+                if (strcmp(option, "warmup") == 0) {
+                    app.benchmark.warmupMS = atof(value) * 1000.0;
+                } else if (strcmp(option, "frames") == 0) {
+                    app.benchmark.frameCount = atoi(value);
+                } else if (strcmp(option, "seconds") == 0) {
+                    app.benchmark.durationMS = atof(value) * 1000.0;
+                } else if (strcmp(option, "output") == 0) {
+                    app.benchmark.outputPath = value;
+                } else {
+                    printf("unknown option %s\n", argv[i - 1]);
+                    return 1;
+                }
+                app.benchmark.enabled = true;
+            } else if (strcmp(argv[i], "--accumulate") == 0) {
+                app.accumulation.enabled = true;
+            } else if (strcmp(argv[i], "--max-samples") == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse --max-samples, expect a number of samples\n");
+                    return 1;
+                }
+                app.accumulation.enabled = true;
+                app.accumulation.maxSamples = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--noise-threshold") == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse --noise-threshold, expect a value like 0.001\n");
+                    return 1;
+                }
+                app.accumulation.enabled = true;
+                app.accumulation.noiseThreshold = float(atof(argv[++i]));
+            } else if (strcmp(argv[i], "--presentation") == 0) {
+                app.presentation = true;
+            } else if (strcmp(argv[i], "--swap-interval") == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse --swap-interval, expect 0, 1 or -1 for adaptive vsync\n");
+                    return 1;
+                }
+                app.swapInterval = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--fullscreen") == 0) {
+                windowStyle = FULLSCREEN;
+            } else if (strcmp(argv[i], "--monitor") == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse --monitor, expect a monitor index\n");
+                    return 1;
+                }
+                windowStyle = FULLSCREEN;
+                app.monitor = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--on-top") == 0) {
+                windowStyle = ALLWAYS_ON_TOP;
+            } else if (strcmp(argv[i], "--hidden-policy") == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse --hidden-policy, expect stop, full, fps:10 or scale:0.25\n");
+                    return 1;
+                }
+                if (!parseBackgroundPolicy(app.background, argv[++i])) {
+                    printf("invalid --hidden-policy %s, expect stop, full, fps:10 or scale:0.25\n", argv[i]);
+                    return 1;
+                }
+            } else if (strcmp(argv[i], "--throttle-unfocused") == 0) {
+                app.background.throttleUnfocused = true;
+            } else if (strcmp(argv[i], "--low-latency") == 0) {
+                app.latency.lowLatency = true;
+            } else if (strcmp(argv[i], "--checkerboard") == 0) {
+                app.checkerboard.enabled = true;
+            } else if (strcmp(argv[i], "--tiled") == 0) {
+                app.tiled.enabled = true;
+            } else if (strncmp(argv[i], "--tile-", 7) == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse %s\n", argv[i]);
+                    return 1;
+                }
+                const char* option = argv[i] + 7;
+                const char* value = argv[++i];
+                if (strcmp(option, "size") == 0) {
+                    app.tiled.tileSize = atoi(value);
+                    if (app.tiled.tileSize < MinTileSize) {
+                        printf("invalid --tile-size %s, expect a size of at least %d pixels\n", value, MinTileSize);
+                        return 1;
+                    }
+                } else if (strcmp(option, "budget") == 0) {
+                    app.tiled.budgetMS = float(atof(value));
+                    if (!(app.tiled.budgetMS > 0.0f)) {
+                        printf("invalid --tile-budget %s, expect a time in milliseconds greater than 0\n", value);
+                        return 1;
+                    }
+                } else if (strcmp(option, "timeout") == 0) {
+                    app.tiled.timeoutMS = float(atof(value));
+                    if (!(app.tiled.timeoutMS > 0.0f)) {
+                        printf("invalid --tile-timeout %s, expect a time in milliseconds greater than 0\n", value);
+                        return 1;
+                    }
+                } else {
+                    printf("unknown option %s\n", argv[i - 1]);
+                    return 1;
+                }
+                app.tiled.enabled = true;
+            } else if (strcmp(argv[i], "--texture-cache") == 0) {
+                if (i + 1 >= argc) {
+                    printf("not enough argument to parse --texture-cache, expect a directory\n");
+                    return 1;
+                }
+                if (!createTextureCacheDirectory(argv[i + 1])) {
+                    return 1;
+                }
+                app.textureCacheDirectory = argv[++i];
+
                 // handle argument texture like:
-                // --texture0 [2d:linear:repeat] file.png
-                // --texture0 [3d:linear:repeat:sizex:sizey:sizez] file
+                // --texture0 [2d:linear:repeat:precision:maxsize=N] file.png
+                // --texture0 [3d:linear:repeat:sizex:sizey:sizez:type] file
             } else if (strncmp(argv[i], "--texture", 9) == 0) {
                 int textureIndex = argv[i][9] - '0';
                 WatchFile fileEntry;
@@ -650,7 +1150,25 @@ int main(int argc, const char** argv)
                     i++;
                 }
                 fileEntry.path = argv[i];
-                app.watcher._files.push_back(fileEntry);
+
+                ChannelSampler& sampler = app.samplers.channels[textureIndex];
+                sampler.enabled = true;
+                sampler.filter = fileEntry.texture.filter;
+                sampler.wrap = fileEntry.texture.wrap;
+                // a file already loaded the same way in another channel is shared, only the sampling differs
+                for (WatchFile& file : app.watcher._files) {
+                    if (file.type != WatchFile::SHADER && file.path == fileEntry.path &&
+                        hasSameTextureContent(file.texture, fileEntry.texture)) {
+                        sampler.source = file.type - int(WatchFile::TEXTURE0);
+                        if (sampler.filter == Texture::LINEAR_MIPMAP_LINEAR) {
+                            file.texture.filter = Texture::LINEAR_MIPMAP_LINEAR;
+                        }
+                        break;
+                    }
+                }
+                if (sampler.source < 0) {
+                    app.watcher._files.push_back(fileEntry);
+                }
             } else {
                 shaderIndex = i;
                 break;
@@ -666,30 +1184,72 @@ int main(int argc, const char** argv)
         printf("no file to watch use the default shader as example\n");
     }
 
+    // the window size can be changed by the pixel ratio so keep the requested size for the offscreen runs
+    app.benchmark.width = app.width;
+    app.benchmark.height = app.height;
+    const int saveFrameWidth = app.width;
+    const int saveFrameHeight = app.height;
+    if (app.benchmark.enabled && app.benchmark.frameCount <= 0 && app.benchmark.durationMS <= 0.0) {
+        app.benchmark.frameCount = benchmarkDefaultFrames;
+    }
+
+    if (app.tiled.enabled && app.accumulation.enabled) {
+        printf("tiled rendering is not supported with the accumulation, tiles are disabled\n");
+        app.tiled.enabled = false;
+    }
+
+    // save-frame waits for the accumulation to converge so it needs a stop condition
+    if (executeOneFrame && app.accumulation.enabled && app.accumulation.maxSamples <= 0 &&
+        app.accumulation.noiseThreshold <= 0.0f) {
+        app.accumulation.maxSamples = saveFrameDefaultSamples;
+        printf("no stop condition for the accumulation, will save the frame after %d samples\n",
+               saveFrameDefaultSamples);
+    }
+
     // dump files from
     for (auto&& entry : app.watcher._files) {
         dumpFileEntry(entry);
     }
 
-    glfwSetErrorCallback(outputError);
+    // non interactive runs do not need a window, without EGL or OSMesa they use a hidden one
+    GLFWwindow* window = nullptr;
+    const bool offscreen = executeOneFrame || app.benchmark.enabled || serveDirectory;
+    const bool useIMGUI = !offscreen && !app.presentation;
+    app.headless = offscreen && setupHeadless();
+    if (app.headless) {
+        app.pixelRatio = 1.0f;
+    } else {
+        glfwSetErrorCallback(outputError);
 
-    if (!glfwInit()) {
-        printf("GLFW init failed\n");
-        return 1;
-    }
+        if (!glfwInit()) {
+            printf("GLFW init failed\n");
+            return 1;
+        }
 
-    GLFWwindow* window = setupWindow(REGULAR, &app);
+        // the offscreen runs only need the context of a hidden window
+        window = setupWindow(offscreen ? HEADLESS : windowStyle, &app);
 
-    if (!window) {
-        return 1;
+        if (!window) {
+            return 1;
+        }
+        if (useIMGUI) {
+            initIMGUI(window);
+        }
     }
 
-    initIMGUI(window);
+    resetGLState();
+    if (!initPresent()) {
+        return 1;
+    }
 
     // setup default fragmentProgram
     // define texture configurations
-    const std::string fragmentTemplate = createFragmentTemplate(app.watcher._files);
+    const std::string fragmentTemplate =
+        createFragmentTemplate(app.watcher._files, &app.samplers, app.accumulation.enabled);
     defaultTemplatePreFragment = fragmentTemplate.c_str();
+    if (app.accumulation.enabled) {
+        defaultTemplatePostFragment = accumulationTemplatePostFragment;
+    }
 
     // fullscreen triangle
     float points[] = {4.0f,  -1.0f, // NOLINT
@@ -702,11 +1262,17 @@ int main(int argc, const char** argv)
 
     GLuint vao = 0;
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    bindVertexArray(vao);
     glEnableVertexAttribArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
 
+    UniformBuffer uniformBuffer;
+    if (!initUniformBuffer(uniformBuffer)) {
+        printf("fails to create the uniform buffer\n");
+        return 1;
+    }
+
     GLuint vs;
     GLuint fs = -1U;
     GLuint program = -1U;
@@ -717,157 +1283,369 @@ int main(int argc, const char** argv)
     }
     getProgramDescription(program, programDescription);
     UniformList uniformList;
-    getUniformList(&programDescription, uniformList);
-
-    app.running.store(true);
-    std::thread fileWatcher(&fileWatcherThread, &app);
-
-    double timeStart = getTimeInMS();
-    double lastFrame = timeStart;
+    getUniformList(&programDescription, defaultFragment, strlen(defaultFragment), uniformList);
 
-    double fpsStart = timeStart;
-    int fpsFrameCount = 0;
+    Channel channels[4];
 
-    GLuint textures[4] = {~0x0u, ~0x0u, ~0x0u, ~0x0u};
-
-    while (app.running.load() && !glfwWindowShouldClose(window)) {
-
-        /* Poll for and process events */
-        glfwPollEvents();
-
-        if (app.watcher.fileChanged()) {
-            app.watcher.lock();
-
-            // be careful do not use 'changedFile' after unlocking
-            const WatchFile& changedFile = app.watcher.getChangedFile();
-            switch (changedFile.type) {
-            case WatchFile::SHADER: {
-                bool status = compileProgram(vs, reinterpret_cast<const char*>(changedFile.data.data()),
-                                             changedFile.data.size(), fs, program, app.shaderReport);
-                app.watcher.resetFileChanged();
-                app.watcher.unlock();
-                if (status) {
-                    ProgramDescription newProgramDescription;
-                    getProgramDescription(program, newProgramDescription);
-                    UniformList newList;
-                    getUniformList(&newProgramDescription, newList);
-                    uniformList = newList;
-                }
-                break;
-            }
-            case WatchFile::TEXTURE0:
-            case WatchFile::TEXTURE1:
-            case WatchFile::TEXTURE2:
-            case WatchFile::TEXTURE3: {
-                int textureIndex = changedFile.type - int(WatchFile::TEXTURE0);
-                updateTexture(textures[textureIndex], uniformList.iChannelResolution[textureIndex],
-                              changedFile.texture);
-                app.watcher.resetFileChanged();
-                app.watcher.unlock();
-                break;
+    // apply the last file loaded by the watcher, returns the index of the file or -1 if nothing changed
+    auto processFileChange = [&]() -> int {
+        if (!app.watcher.fileChanged()) {
+            return -1;
+        }
+        app.watcher.lock();
+
+        // be careful do not use 'changedFile' after unlocking
+        const int fileIndex = app.watcher._fileChanged;
+        const WatchFile& changedFile = app.watcher.getChangedFile();
+        switch (changedFile.type) {
+        case WatchFile::SHADER: {
+            const char* shaderText = reinterpret_cast<const char*>(changedFile.data.data());
+            if (compileProgram(vs, shaderText, changedFile.data.size(), fs, program, app.shaderReport)) {
+                // keep the values, like the channel resolutions, only the locations change
+                ProgramDescription newProgramDescription;
+                getProgramDescription(program, newProgramDescription);
+                getUniformList(&newProgramDescription, shaderText, changedFile.data.size(), uniformList);
+                uniformList.iFrame = 0;
+                resetAccumulation(app.accumulation);
+                resetTiledRender(app.tiled);
             }
+            app.watcher.resetFileChanged();
+            app.watcher.unlock();
+            break;
+        }
+        case WatchFile::TEXTURE0:
+        case WatchFile::TEXTURE1:
+        case WatchFile::TEXTURE2:
+        case WatchFile::TEXTURE3: {
+            int textureIndex = changedFile.type - int(WatchFile::TEXTURE0);
+            Texture& texture = app.watcher._files[size_t(fileIndex)].texture;
+            if (offscreen) {
+                updateTexture(channels[textureIndex], textureIndex, uniformList.iChannelResolution[textureIndex],
+                              texture);
+                shareChannelResolutions(app.samplers, uniformList.iChannelResolution);
+                releaseTextureData(texture);
+                resetAccumulation(app.accumulation);
+            } else {
+                // the channel changes once the copies are done, see continueTextureUploads, or right away when only a
+                // small part of the image changed
+                if (startTextureUpload(app.textureUploads, channels, textureIndex, texture)) {
+                    app.samplers.changed = true;
+                }
             }
-            app.requestFrame = true;
+            app.watcher.resetFileChanged();
+            app.watcher.unlock();
+            break;
         }
-
-        // the app can be in pause in this case we do not render new frame
-        // except if a requestFrame is asked. It happens when resizing the window
-        // or recompiling a program
-        // so requestFrame is a a boolean used as an exception when in pause mode
-        if (app.pause && !app.requestFrame) {
-            sleepInMS(500);
-            continue;
         }
+        app.requestFrame = true;
+        resumeFullRate(app.background, getTimeInMS());
+        return fileIndex;
+    };
+
+    initCompressedTextureSupport();
+    initChannelSamplers(app.samplers);
+    for (WatchFile& file : app.watcher._files) {
+        limitTextureMaxSize(file.texture);
+    }
+    app.running.store(true);
+    std::thread fileWatcher(&fileWatcherThread, &app);
 
-        float mouseX, mouseY;
-        {
-            double xpos, ypos;
-            glfwGetCursorPos(window, &xpos, &ypos);
-            mouseX = static_cast<float>(xpos);
-            mouseY = static_cast<float>(ypos);
+    if (app.benchmark.enabled) {
+        if (!benchmarkShader(app, uniformList, processFileChange,
+                             [&]() { drawFrame(program, vao, channels, &app.samplers, uniformList, uniformBuffer); })) {
+            exitCode = 1;
+        }
+        app.running.store(false);
+    } else if (serveDirectory) {
+        serveSpoolDirectory(app, serveDirectory, vs, fs, program, vao, uniformBuffer);
+        app.running.store(false);
+    } else if (executeOneFrame) {
+        if (!saveFrameOffscreen(app, uniformList, processFileChange,
+                                [&]() { drawFrame(program, vao, channels, &app.samplers, uniformList, uniformBuffer); },
+                                saveImagePath, saveFrameWidth, saveFrameHeight, saveFrameTime)) {
+            exitCode = 1;
         }
+        app.running.store(false);
+    }
 
-        const float viewportWidth = app.width * app.pixelRatio;
-        const float viewportHeight = app.height * app.pixelRatio;
-        mouseX = clamp(mouseX, 0.0f, viewportWidth);
-        mouseY = clamp(mouseY, 0.0f, viewportHeight);
+    // shader output kept when the shader is static so ui updates do not re-render it
+    RenderTarget frameCache;
+    // animated shader drawn at a lower resolution while the window is hidden
+    RenderTarget backgroundFrame;
 
-        // update iMouse
-        if (app.mouseButtonClicked[0]) {
-            uniformList.iMouse[0] = mouseX;
-            uniformList.iMouse[1] = mouseY;
-        }
-        if (app.mouseButtonClicked[1]) {
-            uniformList.iMouse[2] = mouseX;
-            uniformList.iMouse[3] = mouseY;
-        }
+    // the render thread owns the context while the main thread only pumps the window events, so a window drag or
+    // resize, which blocks the event processing on some platforms, does not stop the rendering
+    auto renderLoop = [&]() {
+        glfwMakeContextCurrent(window);
+
+        double timeStart = getTimeInMS();
+        double lastFrame = timeStart;
 
-        // update window dimension
-        uniformList.iResolution[0] = viewportWidth;
-        uniformList.iResolution[1] = viewportHeight;
-        uniformList.iResolution[2] = viewportHeight / viewportWidth;
+        double fpsStart = timeStart;
+        int fpsFrameCount = 0;
 
-        // Clear the background
-        glClear(GL_COLOR_BUFFER_BIT);
+        bool waitEvents = false;
+        int settleFrames = 0;
+        double backgroundDelay = 0.0;
 
-        glDisable(GL_DEPTH_TEST);
+        // the uniforms are kept for a whole tiled pass so all the tiles show the same time
+        UniformList tiledUniforms = uniformList;
 
-        glUseProgram(program);
+        while (app.running.load()) {
 
-        for (int textureIndex = 0; textureIndex < 4; textureIndex++) {
-            if (textures[textureIndex] != ~0x0u) {
-                glActiveTexture(GL_TEXTURE0 + static_cast<unsigned int>(textureIndex));
-                glBindTexture(GL_TEXTURE_2D, textures[textureIndex]);
+            /* Process the queued window events, block until something happens when there is nothing to update */
+            if (waitEvents) {
+                waitInput(app.input);
+                // imgui can need one more frame to settle after an input
+                settleFrames = 1;
+            } else if (backgroundDelay > 0.0) {
+                waitInputFor(app.input, backgroundDelay);
+            }
+            // in low latency mode the inputs are read once the previous frame is done
+            waitFramesInFlight(app.latency);
+            InputEvent event;
+            while (popInput(app.input, event)) {
+                applyInput(&app, event);
+                if (useIMGUI) {
+                    processIMGUIInput(event);
+                }
             }
-        }
 
-        updateUniforms(uniformList);
+            processFileChange();
+            if (continueTextureUploads(app.textureUploads, channels, uniformList.iChannelResolution)) {
+                shareChannelResolutions(app.samplers, uniformList.iChannelResolution);
+                app.samplers.changed = true;
+            }
+            // a texture or the sampling of a channel changed
+            if (app.samplers.changed) {
+                app.samplers.changed = false;
+                resetAccumulation(app.accumulation);
+                app.requestFrame = true;
+            }
 
-        glBindVertexArray(vao);
-        // draw points 0-3 from the currently bound VAO with current in-use shader
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+            // the frame is skipped while the window is hidden, see BackgroundPolicy
+            const bool emptyWindow = app.width <= 0 || app.height <= 0;
+            backgroundDelay = emptyWindow ? -1.0 : getBackgroundDelay(app.background, getTimeInMS(), lastFrame);
+            if (backgroundDelay != 0.0) {
+                waitEvents = backgroundDelay < 0.0;
+                continue;
+            }
+            const float backgroundScale = getBackgroundScale(app.background, getTimeInMS());
+
+            float mouseX = app.cursor[0];
+            float mouseY = app.cursor[1];
+
+            const float viewportWidth = app.width * app.pixelRatio;
+            const float viewportHeight = app.height * app.pixelRatio;
+            mapRegionCursor(app.region, app.pixelRatio, int(viewportWidth), int(viewportHeight), mouseX, mouseY);
+            mouseX = clamp(mouseX, 0.0f, viewportWidth);
+            mouseY = clamp(mouseY, 0.0f, viewportHeight);
+
+            // update iMouse
+            float previousMouse[4];
+            memcpy(previousMouse, uniformList.iMouse, sizeof(previousMouse));
+            if (app.mouseButtonClicked[0]) {
+                uniformList.iMouse[0] = mouseX;
+                uniformList.iMouse[1] = mouseY;
+            }
+            if (app.mouseButtonClicked[1]) {
+                uniformList.iMouse[2] = mouseX;
+                uniformList.iMouse[3] = mouseY;
+            }
 
-        // do not save the ui if execute and save one frame
-        if (!executeOneFrame) {
-            frameIMGUI(&app, uniformList);
-        }
+            // update window dimension
+            uniformList.iResolution[0] = viewportWidth;
+            uniformList.iResolution[1] = viewportHeight;
+            uniformList.iResolution[2] = viewportHeight / viewportWidth;
+
+            // the shader is rendered again only if an input it reads has changed. requestFrame is set when
+            // resizing the window, reloading a file or toggling the pause
+            const bool mouseChanged = memcmp(previousMouse, uniformList.iMouse, sizeof(previousMouse)) != 0;
+            const bool animated = uniformList.usesTime && !app.pause;
+            bool renderShader = app.requestFrame || (mouseChanged && uniformList.usesMouse);
+
+            // accumulate a new sample until the stop condition is reached
+            // any change of resolution or iMouse restarts the accumulation
+            Accumulation& accumulation = app.accumulation;
+            TiledRender& tiled = app.tiled;
+            if (accumulation.enabled) {
+                if (!setupAccumulation(accumulation, int(viewportWidth), int(viewportHeight))) {
+                    break;
+                }
+                if (mouseChanged) {
+                    resetAccumulation(accumulation);
+                }
+                if (!accumulation.converged) {
+                    uniformList.iSampleCount = accumulation.sampleCount;
+                    beginAccumulationSample(accumulation);
+                    drawFrame(program, vao, channels, &app.samplers, uniformList, uniformBuffer);
+                    endAccumulationSample(accumulation);
+                }
+            } else if (tiled.enabled) {
+                if (!setupTiledRender(tiled, int(viewportWidth), int(viewportHeight))) {
+                    break;
+                }
+                if (renderShader || (animated && tiled.passComplete)) {
+                    tiledUniforms = uniformList;
+                    startTiledPass(tiled);
+                }
+                renderTiles(tiled, [&]() {
+                    drawFrame(program, vao, channels, &app.samplers, tiledUniforms, uniformBuffer);
+                });
+            } else if (!animated) {
+                if (frameCache.width != int(viewportWidth) || frameCache.height != int(viewportHeight)) {
+                    destroyRenderTarget(frameCache);
+                    if (!createRenderTarget(frameCache, int(viewportWidth), int(viewportHeight), GL_RGBA8)) {
+                        break;
+                    }
+                    renderShader = true;
+                }
+                if (renderShader) {
+                    bindFramebuffer(frameCache.framebuffer);
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    drawFrame(program, vao, channels, &app.samplers, uniformList, uniformBuffer);
+                    bindFramebuffer(0);
+                }
+            }
 
-        /* Swap front and back buffers */
-        glfwSwapBuffers(window);
+            // Clear the background
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            RegionOfInterest& region = app.region;
+            if (accumulation.enabled) {
+                presentRegionOfInterest(region, accumulation.target.textures[0], int(viewportWidth),
+                                        int(viewportHeight));
+            } else if (tiled.enabled) {
+                presentRegionOfInterest(region, getTiledRenderTexture(tiled), int(viewportWidth), int(viewportHeight));
+            } else if (!animated) {
+                presentRegionOfInterest(region, frameCache.textures[0], int(viewportWidth), int(viewportHeight));
+            } else if (region.active) {
+                if (!setupRegionOfInterest(region, int(viewportWidth), int(viewportHeight))) {
+                    break;
+                }
+                // inputs changing the whole image, like iMouse, need a full frame
+                if (renderShader) {
+                    resetRegionOfInterest(region);
+                }
+                drawRegionOfInterest(region, [&]() {
+                    drawFrame(program, vao, channels, &app.samplers, uniformList, uniformBuffer);
+                });
+                presentRegionOfInterest(region, region.cache.textures[0], int(viewportWidth), int(viewportHeight));
+            } else if (app.checkerboard.enabled) {
+                if (!setupCheckerboard(app.checkerboard, int(viewportWidth), int(viewportHeight))) {
+                    break;
+                }
+                drawCheckerboardFrame(app.checkerboard, int(viewportWidth), int(viewportHeight), [&](int checkerboard) {
+                    uniformList.checkerboard = checkerboard;
+                    drawFrame(program, vao, channels, &app.samplers, uniformList, uniformBuffer);
+                    uniformList.checkerboard = 0;
+                });
+            } else if (backgroundScale < 1.0f) {
+                const int width = std::max(int(viewportWidth * backgroundScale), 1);
+                const int height = std::max(int(viewportHeight * backgroundScale), 1);
+                if (backgroundFrame.width != width || backgroundFrame.height != height) {
+                    destroyRenderTarget(backgroundFrame);
+                    if (!createRenderTarget(backgroundFrame, width, height, GL_RGBA8)) {
+                        break;
+                    }
+                }
+                // iResolution is set again from the window size on the next frame, iMouse is kept in window
+                // pixels to detect its changes so it's only scaled for this draw
+                uniformList.iResolution[0] = float(width);
+                uniformList.iResolution[1] = float(height);
+                float windowMouse[4];
+                memcpy(windowMouse, uniformList.iMouse, sizeof(windowMouse));
+                for (int c = 0; c < 4; c++) {
+                    uniformList.iMouse[c] *= (c % 2 ? float(height) / viewportHeight : float(width) / viewportWidth);
+                }
+                bindFramebuffer(backgroundFrame.framebuffer);
+                glViewport(0, 0, width, height);
+                drawFrame(program, vao, channels, &app.samplers, uniformList, uniformBuffer);
+                memcpy(uniformList.iMouse, windowMouse, sizeof(windowMouse));
+                bindFramebuffer(0);
+                glViewport(0, 0, int(viewportWidth), int(viewportHeight));
+                presentTexture(backgroundFrame.textures[0], int(viewportWidth), int(viewportHeight));
+            } else {
+                drawFrame(program, vao, channels, &app.samplers, uniformList, uniformBuffer);
+            }
 
-        if (executeOneFrame) {
-            screenShoot(&app, saveImagePath);
-            // screenShoot(&app, saveImagePath);
-            break;
-        }
+            if (useIMGUI) {
+                frameIMGUI(&app, uniformList);
+            }
 
-        // updates some var to refresh uniforms
-        uniformList.iFrame++;
-        fpsFrameCount++;
-        {
-            const double now = getTimeInMS();
-            uniformList.iTime = float((now - timeStart) / 1000.0);
-            uniformList.iTimeDelta = float((now - lastFrame) / 1000.0);
-            lastFrame = now;
-
-            // compute fps
-            const double deltaFPS = now - fpsStart;
-            if (deltaFPS >= 1000.0) {
-                app.frameRate = static_cast<float>(double(fpsFrameCount) * 1000.0 / deltaFPS);
-                fpsFrameCount = 0;
-                fpsStart = now;
+            /* Swap front and back buffers */
+            glfwSwapBuffers(window);
+            endLatencyFrame(app.latency);
+            app.glStats = endGLStateFrame();
+
+            // updates some var to refresh uniforms
+            uniformList.iFrame++;
+            uniformList.iFrameRate = app.frameRate;
+            fpsFrameCount++;
+            {
+                const double now = getTimeInMS();
+                uniformList.iTime = float((now - timeStart) / 1000.0);
+                uniformList.iTimeDelta = float((now - lastFrame) / 1000.0);
+                lastFrame = now;
+
+                // compute fps
+                const double deltaFPS = now - fpsStart;
+                if (deltaFPS >= 1000.0) {
+                    app.frameRate = static_cast<float>(double(fpsFrameCount) * 1000.0 / deltaFPS);
+                    fpsFrameCount = 0;
+                    fpsStart = now;
+                }
             }
+
+            // reset the request of frame
+            app.requestFrame = false;
+
+            const bool accumulating = accumulation.enabled && !accumulation.converged;
+            const bool tiling = tiled.enabled && !tiled.passComplete && !tiled.aborted;
+            const bool uploading = hasTextureUploads(app.textureUploads);
+            waitEvents = !animated && !accumulating && !tiling && !uploading && settleFrames-- <= 0;
         }
 
-        // reset the request of frame
-        app.requestFrame = false;
+        glfwMakeContextCurrent(nullptr);
+        // wake the main thread when the loop ends by itself, like when a render target can't be created
+        app.running.store(false);
+        glfwPostEmptyEvent();
+    };
+
+    if (app.running.load()) {
+        glfwMakeContextCurrent(nullptr);
+        std::thread renderThread(renderLoop);
+        while (app.running.load() && !glfwWindowShouldClose(window)) {
+            glfwWaitEvents();
+        }
+        app.running.store(false);
+        wakeInput(app.input);
+        renderThread.join();
+        glfwMakeContextCurrent(window);
     }
     app.running.store(false);
 
     fileWatcher.join();
 
-    cleanupIMGUI();
-    cleanupWindow(window);
+    destroyRenderTarget(frameCache);
+    destroyRenderTarget(backgroundFrame);
+    cleanupAccumulation(app.accumulation);
+    cleanupTextureUploads(app.textureUploads);
+    cleanupTiledRender(app.tiled);
+    cleanupCheckerboard(app.checkerboard);
+    cleanupRegionOfInterest(app.region);
+    cleanupLatency(app.latency);
+    cleanupUniformBuffer(uniformBuffer);
+    cleanupChannelSamplers(app.samplers);
+    cleanupPresent();
+    if (window) {
+        if (useIMGUI) {
+            cleanupIMGUI();
+        }
+        cleanupWindow(window);
+    } else {
+        cleanupHeadless();
+    }
 
-    return 0;
+    return exitCode;
 }
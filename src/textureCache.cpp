@@ -0,0 +1,261 @@
+#include "textureCache.h"
+#include "halfFloat.h"
+#include "hash.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+namespace {
+
+// changing the layout of the file or the decoding invalidates the previous cache files
+const uint32_t CacheVersion = 2;
+const char CacheMagic[8] = {'S', 'J', 'T', 'E', 'X', 'T', 'U', 'R'};
+
+// the levels follow the header from the largest, rows are tightly packed
+struct CacheHeader {
+    char magic[8];
+    uint64_t key;
+    int32_t width;
+    int32_t height;
+    uint32_t format;
+    uint32_t type;
+    uint32_t levelCount;
+    uint32_t version;
+    uint32_t swizzle;
+    uint32_t padding;
+};
+
+std::string getCachePath(const std::string& directory, uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.texture", static_cast<unsigned long long>(key));
+    return directory + name;
+}
+
+size_t getTexelSize(const Texture& texture)
+{
+    return getTextureComponentSize(texture.type) * getTextureChannelCount(texture.format);
+}
+
+// chain of levels down to 1x1 like glGenerateMipmap, returns the total size
+size_t getMipmapLayout(const Texture& texture, std::vector<Texture::Level>& levels)
+{
+    size_t total = 0;
+    int width = texture.size[0];
+    int height = texture.size[1];
+    levels.clear();
+    for (;;) {
+        const size_t size = size_t(width) * size_t(height) * getTexelSize(texture);
+        levels.push_back(Texture::Level{nullptr, size, width, height});
+        total += size;
+        if (width == 1 && height == 1) {
+            break;
+        }
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return total;
+}
+
+uint8_t average(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+    return uint8_t((a + b + c + d + 2) / 4);
+}
+
+uint16_t average(uint16_t a, uint16_t b, uint16_t c, uint16_t d)
+{
+    return uint16_t((a + b + c + d + 2) / 4);
+}
+
+float average(float a, float b, float c, float d)
+{
+    return (a + b + c + d) * 0.25f;
+}
+
+// average the 2x2 texels of the source for each texel of the destination, an odd last row or column is dropped
+template <typename T>
+void downsample(const T* source, const Texture::Level& sourceLevel, T* destination, const Texture::Level& level,
+                size_t channels)
+{
+    for (int y = 0; y < level.height; y++) {
+        const int y0 = y * 2;
+        const int y1 = sourceLevel.height > 1 ? y0 + 1 : y0;
+        for (int x = 0; x < level.width; x++) {
+            const int x0 = x * 2;
+            const int x1 = sourceLevel.width > 1 ? x0 + 1 : x0;
+            const T* texels[4] = {source + (size_t(y0) * size_t(sourceLevel.width) + size_t(x0)) * channels,
+                                  source + (size_t(y0) * size_t(sourceLevel.width) + size_t(x1)) * channels,
+                                  source + (size_t(y1) * size_t(sourceLevel.width) + size_t(x0)) * channels,
+                                  source + (size_t(y1) * size_t(sourceLevel.width) + size_t(x1)) * channels};
+            T* texel = destination + (size_t(y) * size_t(level.width) + size_t(x)) * channels;
+            for (size_t c = 0; c < channels; c++) {
+                texel[c] = average(texels[0][c], texels[1][c], texels[2][c], texels[3][c]);
+            }
+        }
+    }
+}
+
+void downsampleLevel(const Texture& texture, const Texture::Level& source, Texture::Level& level)
+{
+    const size_t channels = getTextureChannelCount(texture.format);
+    uint8_t* destination = const_cast<uint8_t*>(level.data);
+    switch (texture.type) {
+    case Texture::UNSIGNED_BYTE:
+        downsample(source.data, source, destination, level, channels);
+        break;
+    case Texture::UNSIGNED_SHORT:
+        downsample(reinterpret_cast<const uint16_t*>(source.data), source, reinterpret_cast<uint16_t*>(destination),
+                   level, channels);
+        break;
+    case Texture::FLOAT:
+        downsample(reinterpret_cast<const float*>(source.data), source, reinterpret_cast<float*>(destination), level,
+                   channels);
+        break;
+    case Texture::HALF_FLOAT: {
+        // filtered in 32 bits then converted back
+        std::vector<float> sourceFloats(source.size / 2);
+        std::vector<float> floats(level.size / 2);
+        convertHalfToFloat(reinterpret_cast<const uint16_t*>(source.data), sourceFloats.data(), sourceFloats.size());
+        downsample(sourceFloats.data(), source, floats.data(), level, channels);
+        convertFloatToHalf(floats.data(), reinterpret_cast<uint16_t*>(destination), floats.size());
+        break;
+    }
+    }
+}
+
+} // namespace
+
+bool createTextureCacheDirectory(const std::string& directory)
+{
+    struct stat st;
+    if (stat(directory.c_str(), &st) == 0) {
+        return true;
+    }
+#ifdef _WIN32
+    const int result = _mkdir(directory.c_str());
+#else
+    const int result = mkdir(directory.c_str(), 0755);
+#endif
+    if (result != 0) {
+        printf("cant create the texture cache directory %s\n", directory.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool getTextureCacheKey(const char* path, const Texture& texture, uint64_t& key)
+{
+    MappedFile file;
+    if (!mapFile(path, file)) {
+        return false;
+    }
+    // images are flipped for opengl when decoded, the precision only changes float images
+    const uint32_t options[4] = {CacheVersion, 1, texture.fullPrecision ? 1u : 0u, uint32_t(texture.maxSize)};
+    key = hashBuffer(options, sizeof(options), hashBuffer(file.data, file.size));
+    unmapFile(file);
+    return true;
+}
+
+bool readCachedTexture(const std::string& directory, uint64_t key, Texture& texture)
+{
+    const std::string cachePath = getCachePath(directory, key);
+    MappedFile file;
+    if (!mapFile(cachePath.c_str(), file)) {
+        return false;
+    }
+
+    CacheHeader header;
+    bool valid = file.size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, file.data, sizeof(header));
+        valid = memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) == 0 && header.key == key &&
+                header.version == CacheVersion && header.width > 0 && header.height > 0 &&
+                header.format <= Texture::R && header.type <= Texture::FLOAT && header.swizzle <= Texture::OPAQUE_RG;
+    }
+    if (valid) {
+        texture.size[0] = header.width;
+        texture.size[1] = header.height;
+        texture.format = Texture::Format(header.format);
+        texture.type = Texture::Type(header.type);
+        texture.swizzle = Texture::Swizzle(header.swizzle);
+        const size_t total = getMipmapLayout(texture, texture.levels);
+        valid = header.levelCount == texture.levels.size() && file.size == sizeof(header) + total;
+    }
+    if (!valid) {
+        printf("ignore invalid texture cache file %s\n", cachePath.c_str());
+        texture.levels.clear();
+        unmapFile(file);
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    for (Texture::Level& level : texture.levels) {
+        level.data = file.data + offset;
+        offset += level.size;
+    }
+    unmapFile(texture.mapped);
+    texture.mapped = file;
+    texture.data.clear();
+    texture.compression = Texture::UNCOMPRESSED;
+    return true;
+}
+
+void generateMipmapLevels(Texture& texture)
+{
+    std::vector<Texture::Level> levels;
+    const size_t total = getMipmapLayout(texture, levels);
+    // level 0 is already in data, the others are appended
+    texture.data.resize(total);
+    size_t offset = 0;
+    for (size_t i = 0; i < levels.size(); i++) {
+        levels[i].data = texture.data.data() + offset;
+        offset += levels[i].size;
+        if (i > 0) {
+            downsampleLevel(texture, levels[i - 1], levels[i]);
+        }
+    }
+    texture.levels = levels;
+}
+
+bool writeCachedTexture(const std::string& directory, uint64_t key, const Texture& texture)
+{
+    // written next to the final file then renamed, a reader never sees a partial file
+    const std::string cachePath = getCachePath(directory, key);
+    const std::string temporaryPath = cachePath + ".tmp";
+    FILE* file = fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        printf("cant write texture cache file %s\n", temporaryPath.c_str());
+        return false;
+    }
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.key = key;
+    header.width = texture.size[0];
+    header.height = texture.size[1];
+    header.format = uint32_t(texture.format);
+    header.type = uint32_t(texture.type);
+    header.levelCount = uint32_t(texture.levels.size());
+    header.version = CacheVersion;
+    header.swizzle = uint32_t(texture.swizzle);
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const Texture::Level& level : texture.levels) {
+        success = success && fwrite(level.data, 1, level.size, file) == level.size;
+    }
+    success = fclose(file) == 0 && success;
+
+#ifdef _WIN32
+    remove(cachePath.c_str()); // rename doesn't replace an existing file
+#endif
+    if (!success || rename(temporaryPath.c_str(), cachePath.c_str()) != 0) {
+        printf("cant write texture cache file %s\n", cachePath.c_str());
+        remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <string>
+
+// decoded 2d images are stored in a cache directory with their mip chain, keyed by the hash of the file and the load
+// options. Later loads map the cache file and upload the levels from the mapping, without decoding the image nor
+// generating the mipmaps. Cache files are never evicted, the directory can be emptied at any time
+
+bool createTextureCacheDirectory(const std::string& directory);
+// hash of the content of the file and of the options changing the decoded texture
+bool getTextureCacheKey(const char* path, const Texture& texture, uint64_t& key);
+// map the cache file of the key and point texture.levels in it, returns false if there is no valid cache file
+bool readCachedTexture(const std::string& directory, uint64_t key, Texture& texture);
+// fill texture.levels with the mip chain of texture.data, box filtered
+void generateMipmapLevels(Texture& texture);
+bool writeCachedTexture(const std::string& directory, uint64_t key, const Texture& texture);
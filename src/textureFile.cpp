@@ -0,0 +1,177 @@
+#include "textureFile.h"
+#include "compressedTexture.h"
+#include "halfFloat.h"
+#include "textureCache.h"
+#include "textureFormat.h"
+#include "textureResize.h"
+
+#include <stb/stb_image.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace {
+
+const char* const TypeNames[] = {"u8", "u16", "f16", "f32"};
+const char* const FormatNames[] = {"rgba", "rgb", "rg", "r"};
+
+bool isPFM(FILE* file)
+{
+    char magic[2] = {0, 0};
+    const bool pfm = fread(magic, 1, 2, file) == 2 && magic[0] == 'P' && (magic[1] == 'F' || magic[1] == 'f');
+    rewind(file);
+    return pfm;
+}
+
+// portable float map: PF for rgb or Pf for greyscale, the size and a scale whose sign gives the endianness, then the
+// rows from bottom to top like opengl
+bool readPFM(FILE* file, std::vector<float>& pixels, int& width, int& height, int& channel)
+{
+    char magic[3] = {0, 0, 0};
+    float scale = 0.0f;
+    // a single whitespace separates the header from the pixels
+    if (fscanf(file, "%2s %d %d %f", magic, &width, &height, &scale) != 4 || fgetc(file) == EOF || width <= 0 ||
+        height <= 0) {
+        return false;
+    }
+    channel = magic[1] == 'F' ? 3 : 1;
+    pixels.resize(size_t(width) * size_t(height) * size_t(channel));
+    if (fread(pixels.data(), sizeof(float), pixels.size(), file) != pixels.size()) {
+        return false;
+    }
+
+    // a positive scale means big endian
+    if (scale > 0.0f) {
+        for (float& pixel : pixels) {
+            uint8_t* bytes = reinterpret_cast<uint8_t*>(&pixel);
+            const uint8_t swapped[4] = {bytes[3], bytes[2], bytes[1], bytes[0]};
+            memcpy(bytes, swapped, sizeof(swapped));
+        }
+    }
+    return true;
+}
+
+void storeFloatPixels(const float* pixels, size_t count, Texture& texture)
+{
+    if (texture.fullPrecision) {
+        texture.type = Texture::FLOAT;
+        texture.data.resize(count * sizeof(float));
+        memcpy(texture.data.data(), pixels, texture.data.size());
+    } else {
+        texture.type = Texture::HALF_FLOAT;
+        texture.data.resize(count * sizeof(uint16_t));
+        convertFloatToHalf(pixels, reinterpret_cast<uint16_t*>(texture.data.data()), count);
+    }
+}
+
+} // namespace
+
+bool readImageFile(const char* path, const std::string& cacheDirectory, Texture& texture)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        printf("cant open file %s\n", path);
+        return false;
+    }
+
+    texture.swizzle = Texture::NO_SWIZZLE;
+    uint8_t header[12];
+    const size_t headerSize = fread(header, 1, sizeof(header), file);
+    rewind(file);
+    if (isCompressedTextureFile(header, headerSize)) {
+        fclose(file);
+        if (!readCompressedTexture(path, texture)) {
+            return false;
+        }
+        const int largest = std::max(texture.size[0], texture.size[1]);
+        if (downscaleTexture(texture)) {
+            printf("downscale texture %s to %dx%d\n", path, texture.size[0], texture.size[1]);
+        } else if (texture.maxSize > 0 && largest > texture.maxSize) {
+            printf("texture %s is larger than %d and has no smaller level, it's used as it is\n", path,
+                   texture.maxSize);
+        }
+        return true;
+    }
+    unmapFile(texture.mapped);
+    texture.levels.clear();
+    texture.compression = Texture::UNCOMPRESSED;
+
+    uint64_t cacheKey = 0;
+    const bool cached = !cacheDirectory.empty() && getTextureCacheKey(path, texture, cacheKey);
+    if (cached && readCachedTexture(cacheDirectory, cacheKey, texture)) {
+        fclose(file);
+        printf("read image %s %dx%d : %zu %s from the texture cache (%zu levels)\n", path, texture.size[0],
+               texture.size[1], getTextureChannelCount(texture.format), TypeNames[texture.type], texture.levels.size());
+        return true;
+    }
+
+    int& width = texture.size[0];
+    int& height = texture.size[1];
+    int channel = 0;
+    bool success = false;
+    const char* reason = "malformed float map";
+    stbi_set_flip_vertically_on_load(true);
+    if (isPFM(file)) {
+        std::vector<float> pixels;
+        success = readPFM(file, pixels, width, height, channel);
+        if (success) {
+            storeFloatPixels(pixels.data(), pixels.size(), texture);
+        }
+    } else if (stbi_is_hdr_from_file(file)) {
+        reason = nullptr;
+        float* pixels = stbi_loadf_from_file(file, &width, &height, &channel, 0);
+        success = pixels != nullptr;
+        if (success) {
+            storeFloatPixels(pixels, size_t(width) * size_t(height) * size_t(channel), texture);
+            stbi_image_free(pixels);
+        }
+    } else if (stbi_is_16_bit_from_file(file)) {
+        reason = nullptr;
+        stbi_us* pixels = stbi_load_from_file_16(file, &width, &height, &channel, 0);
+        success = pixels != nullptr;
+        if (success) {
+            texture.type = Texture::UNSIGNED_SHORT;
+            texture.data.resize(size_t(width) * size_t(height) * size_t(channel) * sizeof(stbi_us));
+            memcpy(texture.data.data(), pixels, texture.data.size());
+            stbi_image_free(pixels);
+        }
+    } else {
+        reason = nullptr;
+        stbi_uc* pixels = stbi_load_from_file(file, &width, &height, &channel, 0);
+        success = pixels != nullptr;
+        if (success) {
+            texture.type = Texture::UNSIGNED_BYTE;
+            texture.data.resize(size_t(width) * size_t(height) * size_t(channel));
+            memcpy(texture.data.data(), pixels, texture.data.size());
+            stbi_image_free(pixels);
+        }
+    }
+    fclose(file);
+
+    if (!success || channel < 1 || channel > 4) {
+        printf("cant decode image %s: %s\n", path, reason ? reason : stbi_failure_reason());
+        texture.data.clear();
+        return false;
+    }
+    const Texture::Format formats[4] = {Texture::R, Texture::RG, Texture::RGB, Texture::RGBA};
+    texture.format = formats[channel - 1];
+    const size_t saved = reduceTextureFormat(texture);
+    if (saved) {
+        printf("reduce image %s to %s, %zu bytes saved\n", path, FormatNames[texture.format], saved);
+    }
+    const int sourceWidth = width;
+    const int sourceHeight = height;
+    if (downscaleTexture(texture)) {
+        printf("downscale image %s from %dx%d to %dx%d\n", path, sourceWidth, sourceHeight, width, height);
+    }
+    if (cached) {
+        generateMipmapLevels(texture);
+        writeCachedTexture(cacheDirectory, cacheKey, texture);
+    }
+
+    printf("read image %s %dx%d : %d %s (%zu bytes)\n", path, width, height, channel, TypeNames[texture.type],
+           texture.data.size());
+    return true;
+}
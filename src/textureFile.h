@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <string>
+
+// decode a 2d image in texture.data, flipped for opengl: 8 and 16 bits images, radiance .hdr and .pfm float maps.
+// Float images are converted to half floats unless texture.fullPrecision is set. ktx and dds files are read by
+// readCompressedTexture. With a cache directory the decoded image and its mip chain are read from or written to the
+// cache, see textureCache.h
+bool readImageFile(const char* path, const std::string& cacheDirectory, Texture& texture);
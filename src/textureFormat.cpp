@@ -0,0 +1,174 @@
+#include "textureFormat.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_FORMAT_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TEXTURE_FORMAT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// gray: r, g and b are equal in every pixel, opaque: the last component is 1 in every pixel of a rg or rgba image
+struct Analysis {
+    bool gray;
+    bool opaque;
+};
+
+template <typename T>
+void analyzeComponents(const T* pixels, size_t pixelCount, size_t channels, T one, Analysis& analysis)
+{
+    for (size_t i = 0; i < pixelCount && (analysis.gray || analysis.opaque); i++) {
+        const T* pixel = pixels + i * channels;
+        analysis.gray = analysis.gray && pixel[0] == pixel[1] && pixel[1] == pixel[2];
+        analysis.opaque = analysis.opaque && pixel[channels - 1] == one;
+    }
+}
+
+#if defined(TEXTURE_FORMAT_SSE2) || defined(TEXTURE_FORMAT_NEON)
+// one bit for each of the 16 bytes: equal to the next byte, equal to 255
+void compareBytes(const uint8_t* bytes, uint32_t& equalNext, uint32_t& equalMax)
+{
+#ifdef TEXTURE_FORMAT_SSE2
+    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 1));
+    equalNext = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(value, next)));
+    equalMax = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_set1_epi8(-1))));
+#else
+    const uint8_t bitValues[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vld1q_u8(bitValues);
+    const uint8x16_t value = vld1q_u8(bytes);
+    const uint8x16_t equal[2] = {vandq_u8(vceqq_u8(value, vld1q_u8(bytes + 1)), bits),
+                                 vandq_u8(vceqq_u8(value, vdupq_n_u8(255)), bits)};
+    uint32_t masks[2];
+    for (int i = 0; i < 2; i++) {
+        masks[i] = uint32_t(vaddv_u8(vget_low_u8(equal[i]))) | (uint32_t(vaddv_u8(vget_high_u8(equal[i]))) << 8);
+    }
+    equalNext = masks[0];
+    equalMax = masks[1];
+#endif
+}
+
+// blocks of 16 or 48 bytes start on a pixel so the bytes to check are at the same positions in each block, returns the
+// number of pixels analyzed
+size_t analyzeBytes(const uint8_t* pixels, size_t pixelCount, size_t channels, Analysis& analysis)
+{
+    const size_t vectorCount = channels == 3 ? 3 : 1;
+    uint32_t grayMasks[3] = {0, 0, 0};  // r equal to g and g equal to b
+    uint32_t alphaMasks[3] = {0, 0, 0}; // last component
+    for (size_t i = 0; i < vectorCount * 16; i++) {
+        const size_t component = i % channels;
+        if (channels >= 3 && component < 2) {
+            grayMasks[i / 16] |= 1u << (i % 16);
+        }
+        if ((channels == 2 || channels == 4) && component == channels - 1) {
+            alphaMasks[i / 16] |= 1u << (i % 16);
+        }
+    }
+
+    // the last byte of a block is compared with the next one, so a block is analyzed only if a byte follows it
+    const size_t size = pixelCount * channels;
+    const size_t blockSize = vectorCount * 16;
+    size_t offset = 0;
+    for (; offset + blockSize < size && (analysis.gray || analysis.opaque); offset += blockSize) {
+        for (size_t vector = 0; vector < vectorCount; vector++) {
+            uint32_t equalNext;
+            uint32_t equalMax;
+            compareBytes(pixels + offset + vector * 16, equalNext, equalMax);
+            analysis.gray = analysis.gray && (equalNext & grayMasks[vector]) == grayMasks[vector];
+            analysis.opaque = analysis.opaque && (equalMax & alphaMasks[vector]) == alphaMasks[vector];
+        }
+    }
+    return offset / channels;
+}
+#endif
+
+template <typename T>
+void keepComponents(T* pixels, size_t pixelCount, size_t channels, const size_t* components, size_t count)
+{
+    for (size_t i = 0; i < pixelCount; i++) {
+        T pixel[4];
+        memcpy(pixel, pixels + i * channels, channels * sizeof(T));
+        for (size_t c = 0; c < count; c++) {
+            pixels[i * count + c] = pixel[components[c]];
+        }
+    }
+}
+
+} // namespace
+
+size_t reduceTextureFormat(Texture& texture)
+{
+    const size_t channels = getTextureChannelCount(texture.format);
+    const size_t componentSize = getTextureComponentSize(texture.type);
+    const size_t pixelCount = texture.data.size() / (channels * componentSize);
+    Analysis analysis = {channels >= 3, channels == 2 || channels == 4};
+    if (!analysis.gray && !analysis.opaque) {
+        return 0;
+    }
+
+    // components compared as integers, a gray is exact and the alpha is exactly 1
+    uint8_t* data = texture.data.data();
+    switch (texture.type) {
+    case Texture::UNSIGNED_BYTE: {
+        size_t analyzed = 0;
+#if defined(TEXTURE_FORMAT_SSE2) || defined(TEXTURE_FORMAT_NEON)
+        analyzed = analyzeBytes(data, pixelCount, channels, analysis);
+#endif
+        analyzeComponents(data + analyzed * channels, pixelCount - analyzed, channels, uint8_t(0xff), analysis);
+        break;
+    }
+    case Texture::UNSIGNED_SHORT:
+        analyzeComponents(reinterpret_cast<const uint16_t*>(data), pixelCount, channels, uint16_t(0xffff), analysis);
+        break;
+    case Texture::HALF_FLOAT:
+        analyzeComponents(reinterpret_cast<const uint16_t*>(data), pixelCount, channels, uint16_t(0x3c00), analysis);
+        break;
+    case Texture::FLOAT:
+        analyzeComponents(reinterpret_cast<const uint32_t*>(data), pixelCount, channels, uint32_t(0x3f800000),
+                          analysis);
+        break;
+    }
+
+    Texture::Format format;
+    Texture::Swizzle swizzle = Texture::NO_SWIZZLE;
+    const size_t gray[2] = {0, channels - 1};
+    const size_t color[3] = {0, 1, 2};
+    const size_t* components;
+    if (channels >= 3 && analysis.gray) {
+        format = channels == 3 || analysis.opaque ? Texture::R : Texture::RG;
+        swizzle = format == Texture::R ? Texture::GRAY : Texture::GRAY_ALPHA;
+        components = gray;
+    } else if (channels == 4 && analysis.opaque) {
+        format = Texture::RGB;
+        components = color;
+    } else if (channels == 2 && analysis.opaque) {
+        format = Texture::R;
+        swizzle = Texture::OPAQUE_RG;
+        components = gray;
+    } else {
+        return 0;
+    }
+
+    const size_t count = getTextureChannelCount(format);
+    switch (componentSize) {
+    case 1:
+        keepComponents(data, pixelCount, channels, components, count);
+        break;
+    case 2:
+        keepComponents(reinterpret_cast<uint16_t*>(data), pixelCount, channels, components, count);
+        break;
+    case 4:
+        keepComponents(reinterpret_cast<uint32_t*>(data), pixelCount, channels, components, count);
+        break;
+    }
+    const size_t size = pixelCount * count * componentSize;
+    const size_t saved = texture.data.size() - size;
+    texture.data.resize(size);
+    texture.format = format;
+    texture.swizzle = swizzle;
+    return saved;
+}
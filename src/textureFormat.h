@@ -0,0 +1,8 @@
+#pragma once
+
+#include "Texture.h"
+
+// exact reduction of a decoded 2d image: an alpha equal to 1 everywhere is dropped and a gray color is stored once, the
+// texture reads the dropped components back with a swizzle so the shader sees the same values. Returns the number of
+// bytes saved
+size_t reduceTextureFormat(Texture& texture);
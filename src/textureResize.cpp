@@ -0,0 +1,189 @@
+#include "textureResize.h"
+#include "halfFloat.h"
+
+#include <algorithm>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_RESIZE_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TEXTURE_RESIZE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// source texels covered by a texel of the downscaled image, weighted by the part of them it covers
+struct Footprint {
+    int first;
+    int count;
+    size_t weights; // offset of the weights of the texels
+};
+
+void getFootprints(int sourceSize, int size, std::vector<Footprint>& footprints, std::vector<float>& weights)
+{
+    const double ratio = double(sourceSize) / double(size);
+    for (int i = 0; i < size; i++) {
+        const double start = double(i) * ratio;
+        const double end = start + ratio;
+        Footprint footprint = {int(start), 0, weights.size()};
+        for (int j = footprint.first; j < sourceSize && double(j) < end; j++) {
+            const double covered = std::min(end, double(j + 1)) - std::max(start, double(j));
+            weights.push_back(float(covered / ratio));
+            footprint.count++;
+        }
+        footprints.push_back(footprint);
+    }
+}
+
+// destination += source * weight, most of the work of the resampling
+void addWeightedRow(float* destination, const float* source, float weight, size_t count)
+{
+    size_t i = 0;
+#if defined(TEXTURE_RESIZE_SSE2)
+    const __m128 weights = _mm_set1_ps(weight);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 value = _mm_mul_ps(_mm_loadu_ps(source + i), weights);
+        _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), value));
+    }
+#elif defined(TEXTURE_RESIZE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(destination + i, vmlaq_n_f32(vld1q_f32(destination + i), vld1q_f32(source + i), weight));
+    }
+#endif
+    for (; i < count; i++) {
+        destination[i] += source[i] * weight;
+    }
+}
+
+void loadRow(const Texture& texture, const uint8_t* source, float* row, size_t count)
+{
+    switch (texture.type) {
+    case Texture::UNSIGNED_BYTE:
+        for (size_t i = 0; i < count; i++) {
+            row[i] = float(source[i]);
+        }
+        break;
+    case Texture::UNSIGNED_SHORT: {
+        const uint16_t* values = reinterpret_cast<const uint16_t*>(source);
+        for (size_t i = 0; i < count; i++) {
+            row[i] = float(values[i]);
+        }
+        break;
+    }
+    case Texture::HALF_FLOAT:
+        convertHalfToFloat(reinterpret_cast<const uint16_t*>(source), row, count);
+        break;
+    case Texture::FLOAT:
+        memcpy(row, source, count * sizeof(float));
+        break;
+    }
+}
+
+// the weights sum to 1 so integers stay in their range, they are only rounded
+void storeRow(const Texture& texture, const float* row, uint8_t* destination, size_t count)
+{
+    switch (texture.type) {
+    case Texture::UNSIGNED_BYTE:
+        for (size_t i = 0; i < count; i++) {
+            destination[i] = uint8_t(std::min(255.0f, row[i] + 0.5f));
+        }
+        break;
+    case Texture::UNSIGNED_SHORT: {
+        uint16_t* values = reinterpret_cast<uint16_t*>(destination);
+        for (size_t i = 0; i < count; i++) {
+            values[i] = uint16_t(std::min(65535.0f, row[i] + 0.5f));
+        }
+        break;
+    }
+    case Texture::HALF_FLOAT:
+        convertFloatToHalf(row, reinterpret_cast<uint16_t*>(destination), count);
+        break;
+    case Texture::FLOAT:
+        memcpy(destination, row, count * sizeof(float));
+        break;
+    }
+}
+
+// separable box filter: the source rows covered by a row of the result are summed with their weight, then the texels
+// of the sum covered by each texel of the result
+void resampleImage(Texture& texture, int width, int height)
+{
+    const int sourceWidth = texture.size[0];
+    const int sourceHeight = texture.size[1];
+    const size_t channels = getTextureChannelCount(texture.format);
+    const size_t componentSize = getTextureComponentSize(texture.type);
+    const size_t sourceRowSize = size_t(sourceWidth) * channels;
+    const size_t rowSize = size_t(width) * channels;
+
+    std::vector<Footprint> columns;
+    std::vector<Footprint> rows;
+    std::vector<float> weights;
+    getFootprints(sourceWidth, width, columns, weights);
+    getFootprints(sourceHeight, height, rows, weights);
+
+    std::vector<uint8_t> data(rowSize * size_t(height) * componentSize);
+    std::vector<float> sourceRow(sourceRowSize);
+    std::vector<float> sum(sourceRowSize);
+    std::vector<float> row(rowSize);
+    for (int y = 0; y < height; y++) {
+        const Footprint& footprint = rows[size_t(y)];
+        std::fill(sum.begin(), sum.end(), 0.0f);
+        for (int i = 0; i < footprint.count; i++) {
+            const size_t sourceY = size_t(footprint.first + i);
+            loadRow(texture, texture.data.data() + sourceY * sourceRowSize * componentSize, sourceRow.data(),
+                    sourceRowSize);
+            addWeightedRow(sum.data(), sourceRow.data(), weights[footprint.weights + size_t(i)], sourceRowSize);
+        }
+
+        for (int x = 0; x < width; x++) {
+            const Footprint& column = columns[size_t(x)];
+            for (size_t c = 0; c < channels; c++) {
+                float value = 0.0f;
+                for (int i = 0; i < column.count; i++) {
+                    value += sum[size_t(column.first + i) * channels + c] * weights[column.weights + size_t(i)];
+                }
+                row[size_t(x) * channels + c] = value;
+            }
+        }
+        storeRow(texture, row.data(), data.data() + size_t(y) * rowSize * componentSize, rowSize);
+    }
+
+    texture.data.swap(data);
+    texture.size[0] = width;
+    texture.size[1] = height;
+}
+
+} // namespace
+
+bool downscaleTexture(Texture& texture)
+{
+    const int largest = std::max(texture.size[0], texture.size[1]);
+    if (texture.target != Texture::TEXTURE_2D || texture.maxSize <= 0 || largest <= texture.maxSize) {
+        return false;
+    }
+
+    // blocks can't be resampled without decoding them, the first level that fits is used
+    if (texture.compression != Texture::UNCOMPRESSED) {
+        size_t level = 0;
+        while (level < texture.levels.size() &&
+               std::max(texture.levels[level].width, texture.levels[level].height) > texture.maxSize) {
+            level++;
+        }
+        if (level == texture.levels.size()) {
+            return false;
+        }
+        texture.levels.erase(texture.levels.begin(), texture.levels.begin() + ptrdiff_t(level));
+        texture.size[0] = texture.levels[0].width;
+        texture.size[1] = texture.levels[0].height;
+        return true;
+    }
+
+    // the largest side becomes maxSize, the other keeps the aspect ratio
+    const double scale = double(texture.maxSize) / double(largest);
+    const int width = std::max(1, int(double(texture.size[0]) * scale + 0.5));
+    const int height = std::max(1, int(double(texture.size[1]) * scale + 0.5));
+    resampleImage(texture, width, height);
+    return true;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "Texture.h"
+
+// a 2d image larger than texture.maxSize is reduced on load so its largest side is maxSize: a decoded image is
+// resampled with a box filter, a compressed texture drops its mip levels that are too large. Returns false if the
+// texture already fits or can't be reduced, texture.size is the reduced size
+bool downscaleTexture(Texture& texture);
@@ -0,0 +1,686 @@
+#include "textureUpload.h"
+#include "compressedTexture.h"
+#include "glState.h"
+#include "watcher.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace {
+
+// the new textures are filled on the last unit so the textures shown by the channels stay bound
+const int UploadTextureUnit = GLStateTextureUnits - 1;
+// offsets in the pixel buffer are aligned for every component type
+const size_t UploadAlignment = 16;
+// a reload is compared with the image shown by blocks of this size in texels, the changed blocks are merged in
+// rectangles. Above the maximum count of rectangles their bounding box is copied
+const int DirtyBlockSize = 32;
+const size_t MaxDirtyRects = 64;
+
+// rows copied in the pixel buffer at offset, issued once the buffer is unmapped
+struct UploadCopy {
+    int channel;
+    size_t region;
+    int row;
+    int rowCount;
+    size_t offset;
+};
+
+// changed region of the first level, in texels
+struct DirtyRect {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+TextureStorageStats gStorageStats;
+
+int getMipmapLevelCount(int width, int height, int depth)
+{
+    int levelCount = 1;
+    for (int size = std::max(std::max(width, height), depth); size > 1; size /= 2) {
+        levelCount++;
+    }
+    return levelCount;
+}
+
+// bound and selected so the next texture calls change this texture
+void bindUploadTexture(int unit, GLenum target, GLuint texture)
+{
+    bindTexture(unit, target, texture);
+    setActiveTexture(unit);
+}
+
+bool hasSameStorage(const Channel& a, const Channel& b)
+{
+    return a.target == b.target && a.internalFormat == b.internalFormat && a.size[0] == b.size[0] &&
+           a.size[1] == b.size[1] && a.size[2] == b.size[2] && a.levelCount == b.levelCount;
+}
+
+// immutable storage when glTexStorage is available (gl 4.2), the levels are allocated one by one otherwise and
+// glGenerateMipmap allocates the generated ones
+void allocateStorage(const Channel& channel, const std::vector<UploadRegion>& regions)
+{
+    if (GLAD_GL_VERSION_4_2) {
+        if (channel.target == GL_TEXTURE_3D) {
+            glTexStorage3D(GL_TEXTURE_3D, channel.levelCount, channel.internalFormat, channel.size[0], channel.size[1],
+                           channel.size[2]);
+        } else {
+            glTexStorage2D(GL_TEXTURE_2D, channel.levelCount, channel.internalFormat, channel.size[0], channel.size[1]);
+        }
+        return;
+    }
+
+    if (channel.target == GL_TEXTURE_3D) {
+        glTexImage3D(GL_TEXTURE_3D, 0, GLint(channel.internalFormat), channel.size[0], channel.size[1],
+                     channel.size[2], 0, regions[0].format, regions[0].type, nullptr);
+        return;
+    }
+    for (const UploadRegion& region : regions) {
+        if (region.type == 0) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, region.level, channel.internalFormat, region.width, region.height, 0,
+                                   GLsizei(region.rowSize * size_t(region.rowCount)), nullptr);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, region.level, GLint(channel.internalFormat), region.width, region.height, 0,
+                         region.format, region.type, nullptr);
+        }
+    }
+}
+
+// gl formats of the texels of an uncompressed texture
+void getPixelFormat(const Texture& texture, GLenum& internalFormat, GLenum& format, GLenum& type)
+{
+    // sized internal formats indexed by [type][format], 16 bits and float images keep their precision
+    const GLenum internalFormats[4][4] = {
+        {GL_RGBA8, GL_RGB8, GL_RG8, GL_R8},
+        {GL_RGBA16, GL_RGB16, GL_RG16, GL_R16},
+        {GL_RGBA16F, GL_RGB16F, GL_RG16F, GL_R16F},
+        {GL_RGBA32F, GL_RGB32F, GL_RG32F, GL_R32F},
+    };
+    internalFormat = internalFormats[texture.type][texture.format];
+
+    switch (texture.format) {
+    case Texture::RGB:
+        format = GL_RGB;
+        break;
+    case Texture::RGBA:
+        format = GL_RGBA;
+        break;
+    case Texture::RG:
+        format = GL_RG;
+        break;
+    case Texture::R:
+        format = GL_RED;
+        break;
+    }
+
+    switch (texture.type) {
+    case Texture::UNSIGNED_BYTE:
+        type = GL_UNSIGNED_BYTE;
+        break;
+    case Texture::UNSIGNED_SHORT:
+        type = GL_UNSIGNED_SHORT;
+        break;
+    case Texture::HALF_FLOAT:
+        type = GL_HALF_FLOAT;
+        break;
+    case Texture::FLOAT:
+        type = GL_FLOAT;
+        break;
+    }
+}
+
+// storage needed by the texture and the rows of its levels
+void getTextureLayout(const Texture& texture, Channel& storage, std::vector<UploadRegion>& regions,
+                      bool& generateMipmap)
+{
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+    getPixelFormat(texture, internalFormat, format, type);
+    const bool mipmapFilter = texture.filter == Texture::LINEAR_MIPMAP_LINEAR;
+
+    storage = Channel();
+    storage.target = texture.target == Texture::TEXTURE_2D ? GL_TEXTURE_2D : GL_TEXTURE_3D;
+    storage.internalFormat = internalFormat;
+    storage.size[0] = texture.size[0];
+    storage.size[1] = texture.size[1];
+    storage.size[2] = texture.size[2];
+
+    regions.clear();
+    generateMipmap = false;
+    const size_t texelSize = getTextureComponentSize(texture.type) * getTextureChannelCount(texture.format);
+    if (texture.compression != Texture::UNCOMPRESSED) {
+        // mipmaps can't be generated for compressed formats, only the levels of the file are used
+        const GLenum compressedFormat = getCompressedTextureFormat(texture.compression);
+        storage.internalFormat = compressedFormat;
+        storage.levelCount = int(texture.levels.size());
+        for (size_t level = 0; level < texture.levels.size(); level++) {
+            const Texture::Level& data = texture.levels[level];
+            const int blockRows = (data.height + 3) / 4;
+            regions.push_back(UploadRegion{GL_TEXTURE_2D, int(level), 0, data.width, data.height, data.data,
+                                           data.size / size_t(blockRows), blockRows, compressedFormat, 0});
+        }
+
+    } else if (texture.target == Texture::TEXTURE_2D && !texture.levels.empty()) {
+        // mip chain read from the texture cache, only the first level is needed without mipmap filtering
+        storage.levelCount = mipmapFilter ? int(texture.levels.size()) : 1;
+        for (int level = 0; level < storage.levelCount; level++) {
+            const Texture::Level& data = texture.levels[size_t(level)];
+            regions.push_back(UploadRegion{GL_TEXTURE_2D, level, 0, data.width, data.height, data.data,
+                                           size_t(data.width) * texelSize, data.height, format, type});
+        }
+
+    } else if (texture.target == Texture::TEXTURE_2D) {
+        regions.push_back(UploadRegion{GL_TEXTURE_2D, 0, 0, texture.size[0], texture.size[1], texture.data.data(),
+                                       size_t(texture.size[0]) * texelSize, texture.size[1], format, type});
+        generateMipmap = mipmapFilter;
+        storage.levelCount = generateMipmap ? getMipmapLevelCount(texture.size[0], texture.size[1], 1) : 1;
+
+    } else {
+        // slices are copied from the mapping one at a time, only the pages of the slices being copied are read
+        const size_t rowSize = size_t(texture.size[0]) * texelSize;
+        const size_t sliceSize = rowSize * size_t(texture.size[1]);
+        for (int z = 0; z < texture.size[2]; z++) {
+            regions.push_back(UploadRegion{GL_TEXTURE_3D, 0, z, texture.size[0], texture.size[1],
+                                           texture.mapped.data + size_t(z) * sliceSize, rowSize, texture.size[1],
+                                           format, type});
+        }
+        generateMipmap = mipmapFilter;
+        storage.levelCount =
+            generateMipmap ? getMipmapLevelCount(texture.size[0], texture.size[1], texture.size[2]) : 1;
+    }
+}
+
+// list the rows to copy in the texture of the channel, the texture is kept if it has the storage they need or created
+// again with this storage
+void setupTexture(const Texture& texture, int unit, Channel& channel, std::vector<UploadRegion>& regions,
+                  bool& generateMipmap)
+{
+    GLint wrap = texture.wrap == Texture::REPEAT ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+    GLint minFilter;
+    GLint magFilter;
+    switch (texture.filter) {
+    case Texture::LINEAR:
+        magFilter = minFilter = GL_LINEAR;
+        break;
+    case Texture::LINEAR_MIPMAP_LINEAR:
+        minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        magFilter = GL_LINEAR;
+        break;
+    case Texture::NEAREST:
+        magFilter = minFilter = GL_NEAREST;
+        break;
+    }
+
+    Channel storage;
+    getTextureLayout(texture, storage, regions, generateMipmap);
+    const bool inPlace = channel.texture != ~0x0u && hasSameStorage(channel, storage);
+    if (inPlace) {
+        gStorageStats.inPlace++;
+    } else {
+        if (channel.texture != ~0x0u) {
+            deleteTexture(channel.texture);
+        }
+        channel = storage;
+        glGenTextures(1, &channel.texture);
+        gStorageStats.reallocations++;
+    }
+    bindUploadTexture(unit, channel.target, channel.texture);
+
+    glTexParameteri(channel.target, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(channel.target, GL_TEXTURE_WRAP_T, wrap);
+    if (channel.target == GL_TEXTURE_3D) {
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, wrap);
+    }
+    glTexParameteri(channel.target, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTexParameteri(channel.target, GL_TEXTURE_MAG_FILTER, magFilter);
+    // indexed by Texture::Swizzle, a reduced format is read with the components of the image
+    const GLint swizzles[4][4] = {
+        {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA},
+        {GL_RED, GL_RED, GL_RED, GL_ONE},
+        {GL_RED, GL_RED, GL_RED, GL_GREEN},
+        {GL_RED, GL_ONE, GL_ZERO, GL_ONE},
+    };
+    glTexParameteriv(channel.target, GL_TEXTURE_SWIZZLE_RGBA, swizzles[texture.swizzle]);
+    if (!generateMipmap) {
+        glTexParameteri(channel.target, GL_TEXTURE_MAX_LEVEL, channel.levelCount - 1);
+    }
+    if (!inPlace) {
+        allocateStorage(channel, regions);
+    }
+}
+
+// pixels is a pointer to the rows, or an offset in the bound pixel buffer. The texture must be bound
+void copyRows(const UploadRegion& region, int row, int rowCount, const void* pixels)
+{
+    if (region.type == 0) {
+        // rows of 4x4 blocks, the last one can be partial
+        const int y = row * 4;
+        const int height = std::min(rowCount * 4, region.height - y);
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, region.level, 0, y, region.width, height, region.format,
+                                  GLsizei(size_t(rowCount) * region.rowSize), pixels);
+        return;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, region.rowSize % 4 ? 1 : 4);
+    if (region.target == GL_TEXTURE_3D) {
+        glTexSubImage3D(GL_TEXTURE_3D, 0, 0, row, region.slice, region.width, rowCount, 1, region.format, region.type,
+                        pixels);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, region.level, 0, row, region.width, rowCount, region.format, region.type,
+                        pixels);
+    }
+}
+
+bool isUploading(const TextureUpload& upload)
+{
+    return upload.channel.texture != ~0x0u;
+}
+
+// the texture is reused by the next upload of the channel if it needs the same storage
+void keepSpareTexture(TextureUpload& upload, const Channel& channel)
+{
+    if (upload.spare.texture != ~0x0u) {
+        deleteTexture(upload.spare.texture);
+    }
+    upload.spare = channel;
+}
+
+void cancelTextureUpload(TextureUpload& upload)
+{
+    if (upload.fence) {
+        glDeleteSync(upload.fence);
+        upload.fence = nullptr;
+    }
+    if (isUploading(upload)) {
+        keepSpareTexture(upload, upload.channel);
+        upload.channel = Channel();
+    }
+    releaseTextureData(upload.texture);
+    upload.regions.clear();
+}
+
+// copy the next rows of the uploads in the pixel buffer, at least one row even if it's larger than the budget
+void stageTextureUploads(TextureUploads& uploads, uint8_t* buffer, size_t bufferSize, std::vector<UploadCopy>& copies)
+{
+    size_t offset = 0;
+    for (int channel = 0; channel < 4; channel++) {
+        TextureUpload& upload = uploads.channels[channel];
+        while (isUploading(upload) && upload.region < upload.regions.size()) {
+            const UploadRegion& region = upload.regions[upload.region];
+            const size_t available = offset < bufferSize ? bufferSize - offset : 0;
+            const int rowCount = std::min(region.rowCount - upload.row, int(available / region.rowSize));
+            if (rowCount <= 0) {
+                return;
+            }
+            const size_t size = size_t(rowCount) * region.rowSize;
+            memcpy(buffer + offset, region.data + size_t(upload.row) * region.rowSize, size);
+            copies.push_back(UploadCopy{channel, upload.region, upload.row, rowCount, offset});
+            offset = (offset + size + UploadAlignment - 1) / UploadAlignment * UploadAlignment;
+
+            upload.row += rowCount;
+            if (upload.row == region.rowCount) {
+                upload.region++;
+                upload.row = 0;
+            }
+        }
+    }
+}
+
+const uint8_t* getFirstLevel(const Texture& texture)
+{
+    return texture.levels.empty() ? texture.data.data() : texture.levels[0].data;
+}
+
+// the image shown by the channel is kept only for the 2d images, the others are always copied again
+void keepPreviousImage(TextureUpload& upload)
+{
+    releaseTextureData(upload.previous);
+    if (upload.texture.target == Texture::TEXTURE_2D && upload.texture.compression == Texture::UNCOMPRESSED) {
+        upload.previous = std::move(upload.texture);
+        upload.texture.mapped = MappedFile();
+    }
+    releaseTextureData(upload.texture);
+}
+
+// the rows equal in both images are skipped with a single memcmp, vectorized by the c library, only the rows that
+// differ are compared block by block
+void findDirtyRects(const uint8_t* previous, const uint8_t* pixels, int width, int height, size_t texelSize,
+                    std::vector<DirtyRect>& rects)
+{
+    const int columns = (width + DirtyBlockSize - 1) / DirtyBlockSize;
+    const size_t rowSize = size_t(width) * texelSize;
+    const size_t blockSize = size_t(DirtyBlockSize) * texelSize;
+    std::vector<bool> dirty(size_t(columns), false);
+    rects.clear();
+    for (int top = 0; top < height; top += DirtyBlockSize) {
+        const int bottom = std::min(height, top + DirtyBlockSize);
+        std::fill(dirty.begin(), dirty.end(), false);
+        for (int y = top; y < bottom; y++) {
+            const uint8_t* a = previous + size_t(y) * rowSize;
+            const uint8_t* b = pixels + size_t(y) * rowSize;
+            if (memcmp(a, b, rowSize) == 0) {
+                continue;
+            }
+            for (int column = 0; column < columns; column++) {
+                const size_t start = size_t(column) * blockSize;
+                dirty[size_t(column)] =
+                    dirty[size_t(column)] || memcmp(a + start, b + start, std::min(blockSize, rowSize - start)) != 0;
+            }
+        }
+
+        // spans of changed blocks, a span below the same span of the previous row of blocks extends its rectangle
+        for (int column = 0; column < columns; column++) {
+            if (!dirty[size_t(column)]) {
+                continue;
+            }
+            int end = column;
+            while (end < columns && dirty[size_t(end)]) {
+                end++;
+            }
+            const int x = column * DirtyBlockSize;
+            const int spanWidth = std::min(width, end * DirtyBlockSize) - x;
+            auto above = std::find_if(rects.begin(), rects.end(), [&](const DirtyRect& rect) {
+                return rect.x == x && rect.width == spanWidth && rect.y + rect.height == top;
+            });
+            if (above != rects.end()) {
+                above->height += bottom - top;
+            } else {
+                rects.push_back(DirtyRect{x, top, spanWidth, bottom - top});
+            }
+            column = end;
+        }
+    }
+
+    if (rects.size() > MaxDirtyRects) {
+        DirtyRect bounds = rects[0];
+        for (const DirtyRect& rect : rects) {
+            const int right = std::max(bounds.x + bounds.width, rect.x + rect.width);
+            const int bottom = std::max(bounds.y + bounds.height, rect.y + rect.height);
+            bounds.x = std::min(bounds.x, rect.x);
+            bounds.y = std::min(bounds.y, rect.y);
+            bounds.width = right - bounds.x;
+            bounds.height = bottom - bounds.y;
+        }
+        rects.assign(1, bounds);
+    }
+}
+
+// texels of the level covering the rectangle of the first level, a texel of a level is the average of 2x2 texels of
+// the level above
+void getLevelRect(const DirtyRect& rect, int level, int levelWidth, int levelHeight, DirtyRect& levelRect)
+{
+    levelRect.x = rect.x >> level;
+    levelRect.y = rect.y >> level;
+    levelRect.width = std::min(levelWidth, ((rect.x + rect.width - 1) >> level) + 1) - levelRect.x;
+    levelRect.height = std::min(levelHeight, ((rect.y + rect.height - 1) >> level) + 1) - levelRect.y;
+}
+
+// the levels from firstLevel are filtered from the level above with linear blits of half size, they average the 2x2
+// texels like glGenerateMipmap. The filter of glGenerateMipmap for a size that is not a power of two is up to the
+// driver, the whole texture is filtered again in this case or if the format can't be rendered to. The texture must be
+// bound on the upload unit
+void filterDirtyRects(TextureUploads& uploads, const Channel& channel, int firstLevel,
+                      const std::vector<DirtyRect>& rects)
+{
+    if ((channel.size[0] & (channel.size[0] - 1)) != 0 || (channel.size[1] & (channel.size[1] - 1)) != 0) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        return;
+    }
+
+    // the size of a framebuffer is the one of its smallest attachment, the levels are read and written with two
+    if (uploads.framebuffers[0] == ~0x0u) {
+        glGenFramebuffers(2, uploads.framebuffers);
+    }
+    // the draw framebuffer is the one of the gl state, reset with both bindings by the next bindFramebuffer
+    bindFramebuffer(uploads.framebuffers[1]);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, uploads.framebuffers[0]);
+
+    bool complete = true;
+    for (int level = firstLevel; level < channel.levelCount && complete; level++) {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, channel.texture, level - 1);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, channel.texture, level);
+        complete = glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE &&
+                   glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        const int sourceWidth = std::max(1, channel.size[0] >> (level - 1));
+        const int sourceHeight = std::max(1, channel.size[1] >> (level - 1));
+        const int width = std::max(1, channel.size[0] >> level);
+        const int height = std::max(1, channel.size[1] >> level);
+        for (size_t i = 0; i < rects.size() && complete; i++) {
+            DirtyRect rect;
+            getLevelRect(rects[i], level, width, height, rect);
+            glBlitFramebuffer(rect.x * 2, rect.y * 2, std::min(sourceWidth, (rect.x + rect.width) * 2),
+                              std::min(sourceHeight, (rect.y + rect.height) * 2), rect.x, rect.y, rect.x + rect.width,
+                              rect.y + rect.height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        }
+    }
+    // detached so the framebuffers don't keep a deleted texture alive
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    bindFramebuffer(0);
+
+    if (!complete) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+// copy the rectangles of the reload that differ from the image shown by the channel in its texture, when the storage is
+// the same and the copies are small enough for a frame. Returns false if the whole texture must be copied again
+bool updateDirtyRects(TextureUploads& uploads, int channel, const Channel& current, const Texture& previous,
+                      const Texture& texture, std::vector<DirtyRect>& rects)
+{
+    const uint8_t* previousPixels = getFirstLevel(previous);
+    const uint8_t* pixels = getFirstLevel(texture);
+    if (!previousPixels || !pixels || current.texture == ~0x0u || texture.target != Texture::TEXTURE_2D ||
+        texture.compression != Texture::UNCOMPRESSED || texture.size[0] != previous.size[0] ||
+        texture.size[1] != previous.size[1] || texture.type != previous.type || texture.format != previous.format ||
+        texture.swizzle != previous.swizzle || texture.filter != previous.filter || texture.wrap != previous.wrap) {
+        return false;
+    }
+    Channel storage;
+    std::vector<UploadRegion> regions;
+    bool generateMipmap = false;
+    getTextureLayout(texture, storage, regions, generateMipmap);
+    if (!hasSameStorage(current, storage)) {
+        return false;
+    }
+
+    const size_t texelSize = getTextureComponentSize(texture.type) * getTextureChannelCount(texture.format);
+    findDirtyRects(previousPixels, pixels, texture.size[0], texture.size[1], texelSize, rects);
+    size_t dirtySize = 0;
+    for (const DirtyRect& rect : rects) {
+        dirtySize += size_t(rect.width) * size_t(rect.height) * texelSize;
+    }
+    const size_t size = size_t(texture.size[0]) * size_t(texture.size[1]) * texelSize;
+    if (dirtySize > uploads.frameBudget || dirtySize * 2 > size) {
+        return false;
+    }
+    if (rects.empty()) {
+        return true;
+    }
+
+    // the levels of the texture cache are copied, the others are filtered on the gpu
+    bindUploadTexture(UploadTextureUnit, GL_TEXTURE_2D, current.texture);
+    for (const UploadRegion& region : regions) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, region.rowSize % 4 ? 1 : 4);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, region.width);
+        for (const DirtyRect& dirty : rects) {
+            DirtyRect rect;
+            getLevelRect(dirty, region.level, region.width, region.height, rect);
+            const uint8_t* data = region.data + (size_t(rect.y) * size_t(region.width) + size_t(rect.x)) * texelSize;
+            glTexSubImage2D(GL_TEXTURE_2D, region.level, rect.x, rect.y, rect.width, rect.height, region.format,
+                            region.type, data);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    if (int(regions.size()) < current.levelCount) {
+        filterDirtyRects(uploads, current, int(regions.size()), rects);
+    }
+
+    printf("update texture %d in %zu rectangles, %zu bytes\n", channel, rects.size(), dirtySize);
+    gStorageStats.partial++;
+    return true;
+}
+
+} // namespace
+
+void updateTexture(Channel& channel, int unit, float* size, const Texture& texture)
+{
+    // upload on the unit of the channel so the binding is already right for the next draw
+    std::vector<UploadRegion> regions;
+    bool generateMipmap = false;
+    setupTexture(texture, unit, channel, regions, generateMipmap);
+    for (const UploadRegion& region : regions) {
+        copyRows(region, 0, region.rowCount, region.data);
+    }
+    if (generateMipmap) {
+        glGenerateMipmap(channel.target);
+    }
+
+    size[0] = float(texture.size[0]);
+    size[1] = float(texture.size[1]);
+    size[2] = float(texture.size[2]);
+}
+
+bool startTextureUpload(TextureUploads& uploads, Channel* channels, int channel, Texture& texture)
+{
+    TextureUpload& upload = uploads.channels[channel];
+    cancelTextureUpload(upload);
+
+    // the channel still shows the previous image, a pending upload of another version is cancelled
+    std::vector<DirtyRect> rects;
+    if (updateDirtyRects(uploads, channel, channels[channel], upload.previous, texture, rects)) {
+        upload.texture = std::move(texture);
+        texture.data.clear();
+        texture.levels.clear();
+        texture.mapped = MappedFile();
+        keepPreviousImage(upload);
+        return !rects.empty();
+    }
+
+    // the watcher reads the next version of the file in the texture while this one is copied
+    upload.texture = std::move(texture);
+    texture.data.clear();
+    texture.levels.clear();
+    texture.mapped = MappedFile();
+
+    upload.channel = upload.spare;
+    upload.spare = Channel();
+    setupTexture(upload.texture, UploadTextureUnit, upload.channel, upload.regions, upload.generateMipmap);
+    upload.region = 0;
+    upload.row = 0;
+    return false;
+}
+
+bool continueTextureUploads(TextureUploads& uploads, Channel* channels, float (*resolutions)[3])
+{
+    bool changed = false;
+    size_t bufferSize = uploads.frameBudget;
+    bool staging = false;
+    for (int channel = 0; channel < 4; channel++) {
+        TextureUpload& upload = uploads.channels[channel];
+        if (upload.fence) {
+            const GLenum status = glClientWaitSync(upload.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                glDeleteSync(upload.fence);
+                upload.fence = nullptr;
+                keepSpareTexture(upload, channels[channel]);
+                channels[channel] = upload.channel;
+                upload.channel = Channel();
+                for (int i = 0; i < 3; i++) {
+                    resolutions[channel][i] = float(upload.texture.size[i]);
+                }
+                keepPreviousImage(upload);
+                changed = true;
+            }
+        } else if (isUploading(upload) && upload.region < upload.regions.size()) {
+            bufferSize = std::max(bufferSize, upload.regions[upload.region].rowSize);
+            staging = true;
+        }
+    }
+
+    if (staging) {
+        // orphaned so the driver gives new storage if the gpu still reads the previous content of the buffer
+        GLuint& buffer = uploads.buffers[uploads.nextBuffer];
+        uploads.nextBuffer = (uploads.nextBuffer + 1) % 3;
+        if (buffer == ~0x0u) {
+            glGenBuffers(1, &buffer);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(bufferSize), nullptr, GL_STREAM_DRAW);
+        void* data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(bufferSize),
+                                      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        std::vector<UploadCopy> copies;
+        if (data) {
+            stageTextureUploads(uploads, static_cast<uint8_t*>(data), bufferSize, copies);
+        }
+        if (!data || glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+            // the content of the buffer is lost, the rows are copied again on the next frame
+            printf("cant map the texture upload buffer\n");
+            for (auto it = copies.rbegin(); it != copies.rend(); ++it) {
+                uploads.channels[it->channel].region = it->region;
+                uploads.channels[it->channel].row = it->row;
+            }
+            copies.clear();
+        }
+        for (const UploadCopy& copy : copies) {
+            const TextureUpload& upload = uploads.channels[copy.channel];
+            bindUploadTexture(UploadTextureUnit, upload.channel.target, upload.channel.texture);
+            copyRows(upload.regions[copy.region], copy.row, copy.rowCount, reinterpret_cast<const void*>(copy.offset));
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    for (TextureUpload& upload : uploads.channels) {
+        if (isUploading(upload) && !upload.fence && upload.region == upload.regions.size()) {
+            if (upload.generateMipmap) {
+                bindUploadTexture(UploadTextureUnit, upload.channel.target, upload.channel.texture);
+                glGenerateMipmap(upload.channel.target);
+            }
+            upload.regions.clear();
+            upload.region = 0;
+            upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    }
+    return changed;
+}
+
+bool hasTextureUploads(const TextureUploads& uploads)
+{
+    for (const TextureUpload& upload : uploads.channels) {
+        if (isUploading(upload)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void cleanupTextureUploads(TextureUploads& uploads)
+{
+    for (TextureUpload& upload : uploads.channels) {
+        cancelTextureUpload(upload);
+        keepSpareTexture(upload, Channel());
+        releaseTextureData(upload.previous);
+    }
+    for (GLuint& buffer : uploads.buffers) {
+        if (buffer != ~0x0u) {
+            glDeleteBuffers(1, &buffer);
+            buffer = ~0x0u;
+        }
+    }
+    for (GLuint& framebuffer : uploads.framebuffers) {
+        if (framebuffer != ~0x0u) {
+            deleteFramebuffer(framebuffer);
+            framebuffer = ~0x0u;
+        }
+    }
+}
+
+TextureStorageStats getTextureStorageStats()
+{
+    return gStorageStats;
+}
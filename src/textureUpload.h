@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Channel.h"
+#include "Texture.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// reloaded textures are copied to the gpu over several frames: each frame copies at most frameBudget bytes of rows in
+// a pixel buffer of a small ring, orphaned before being filled, and issues the copies from it. The channel keeps its
+// previous texture until a fence tells all the copies of the new one are done, so a large image doesn't stall a frame.
+// A texture is created only when the storage changes: the texture replaced in a channel is kept and filled again by the
+// next reload of the same size and format. The image shown by a channel is kept to be compared with the next reload of
+// a 2d image, when only a small part changed (painting in an image editor) the changed rectangles are copied in the
+// texture of the channel right away with their mip regions
+
+// rows of a level of a 2d texture or of a slice of a volume
+struct UploadRegion {
+    GLenum target;
+    int level;
+    int slice; // z of the slice for a volume
+    int width; // texels
+    int height;
+    const uint8_t* data;
+    size_t rowSize; // bytes of a row of texels, or of a row of blocks for a compressed texture
+    int rowCount;
+    GLenum format; // compressed format for a compressed texture
+    GLenum type;   // 0 for a compressed texture
+};
+
+struct TextureUpload {
+    Texture texture;  // owns the pixels until the texture is shown
+    Channel channel;  // new texture, not bound to the channel yet
+    Channel spare;    // previous texture of the channel
+    Texture previous; // image shown by the channel, for the 2d images
+    std::vector<UploadRegion> regions;
+    size_t region = 0; // next row to copy
+    int row = 0;
+    bool generateMipmap = false; // once all the rows are copied
+    GLsync fence = nullptr;      // set once all the copies are issued
+};
+
+struct TextureStorageStats {
+    int reallocations = 0; // textures created for a new storage
+    int inPlace = 0;       // textures filled again in their storage
+    int partial = 0;       // textures updated only in the rectangles that changed
+};
+
+struct TextureUploads {
+    size_t frameBudget = size_t(16) << 20;
+    GLuint buffers[3] = {~0x0u, ~0x0u, ~0x0u};
+    int nextBuffer = 0;
+    GLuint framebuffers[2] = {~0x0u, ~0x0u}; // the mip regions of the changed rectangles are filtered with blits
+    TextureUpload channels[4];
+};
+
+// synchronous upload from the memory of the texture, for the offscreen modes that draw right after loading. The texture
+// of the channel is filled again if it has the same storage
+void updateTexture(Channel& channel, int unit, float* size, const Texture& texture);
+
+// create the new texture of the channel and take the pixels of the texture, a pending upload of the channel is
+// cancelled. The settings of the texture are kept for the next read. Returns true if the texture of the channel was
+// updated right away in the rectangles that changed since the image it shows
+bool startTextureUpload(TextureUploads& uploads, Channel* channels, int channel, Texture& texture);
+// copy the next rows and replace the textures of the channels whose copies are done, returns true if a channel changed
+bool continueTextureUploads(TextureUploads& uploads, Channel* channels, float (*resolutions)[3]);
+bool hasTextureUploads(const TextureUploads& uploads);
+void cleanupTextureUploads(TextureUploads& uploads);
+// counters since the start
+TextureStorageStats getTextureStorageStats();
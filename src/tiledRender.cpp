@@ -0,0 +1,135 @@
+#include "tiledRender.h"
+#include "glState.h"
+
+#include <stdio.h>
+
+namespace {
+
+int getTileColumns(const TiledRender& tiled)
+{
+    return (tiled.targets[0].width + tiled.tileSize - 1) / tiled.tileSize;
+}
+
+int getTileRows(const TiledRender& tiled)
+{
+    return (tiled.targets[0].height + tiled.tileSize - 1) / tiled.tileSize;
+}
+
+} // namespace
+
+bool setupTiledRender(TiledRender& tiled, int width, int height)
+{
+    if (tiled.targets[0].framebuffer && tiled.targets[0].width == width && tiled.targets[0].height == height) {
+        return true;
+    }
+
+    for (RenderTarget& target : tiled.targets) {
+        destroyRenderTarget(target);
+        if (!createRenderTarget(target, width, height, GL_RGBA8)) {
+            return false;
+        }
+    }
+    if (!tiled.query) {
+        glGenQueries(1, &tiled.query);
+    }
+    tiled.hasCompleteImage = false;
+    startTiledPass(tiled);
+    return true;
+}
+
+void startTiledPass(TiledRender& tiled)
+{
+    tiled.passComplete = false;
+    tiled.nextTile = 0;
+    tiled.tileCount = getTileColumns(tiled) * getTileRows(tiled);
+    tiled.currentPassMS = 0.0f;
+}
+
+void resetTiledRender(TiledRender& tiled)
+{
+    tiled.aborted = false;
+    startTiledPass(tiled);
+}
+
+bool renderTiles(TiledRender& tiled, const std::function<void()>& draw)
+{
+    if (tiled.aborted || tiled.passComplete) {
+        return tiled.passComplete;
+    }
+
+    const RenderTarget& target = tiled.targets[tiled.current];
+    bindFramebuffer(target.framebuffer);
+    setCapability(GL_SCISSOR_TEST, true);
+
+    const int columns = getTileColumns(tiled);
+    float spentMS = 0.0f;
+    int submitted = 0;
+    // at least one tile per frame, then only the tiles expected to fit in the budget
+    while (tiled.nextTile < tiled.tileCount && (submitted == 0 || spentMS + tiled.tileMS <= tiled.budgetMS)) {
+        const int x = (tiled.nextTile % columns) * tiled.tileSize;
+        const int y = (tiled.nextTile / columns) * tiled.tileSize;
+        glScissor(x, y, tiled.tileSize, tiled.tileSize);
+
+        glBeginQuery(GL_TIME_ELAPSED, tiled.query);
+        draw();
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // the wait bounds how long shaderjoy waits for the gpu, the submitted work itself can't be cancelled
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        const GLenum status =
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(double(tiled.timeoutMS) * 1000000.0));
+        glDeleteSync(fence);
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+            if (tiled.tileSize / 2 >= MinTileSize) {
+                tiled.tileSize /= 2;
+                printf("a tile takes more than %.0f ms, tile size reduced to %d pixels\n", double(tiled.timeoutMS),
+                       tiled.tileSize);
+                startTiledPass(tiled);
+            } else {
+                tiled.aborted = true;
+                printf("shader stopped: a %dx%d tile takes more than %.0f ms, save the shader to run it again\n",
+                       tiled.tileSize, tiled.tileSize, double(tiled.timeoutMS));
+            }
+            break;
+        }
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(tiled.query, GL_QUERY_RESULT, &elapsed);
+        tiled.tileMS = float(double(elapsed) / 1000000.0);
+        spentMS += tiled.tileMS;
+        tiled.currentPassMS += tiled.tileMS;
+        tiled.nextTile++;
+        submitted++;
+    }
+
+    setCapability(GL_SCISSOR_TEST, false);
+    bindFramebuffer(0);
+
+    if (tiled.nextTile == tiled.tileCount && !tiled.aborted) {
+        tiled.passComplete = true;
+        tiled.hasCompleteImage = true;
+        tiled.passMS = tiled.currentPassMS;
+        tiled.current = 1 - tiled.current;
+    }
+    return tiled.passComplete;
+}
+
+GLuint getTiledRenderTexture(const TiledRender& tiled)
+{
+    // current was swapped at the end of the last pass so the other target holds the complete image
+    const int index = tiled.hasCompleteImage ? 1 - tiled.current : tiled.current;
+    return tiled.targets[index].textures[0];
+}
+
+void cleanupTiledRender(TiledRender& tiled)
+{
+    for (RenderTarget& target : tiled.targets) {
+        destroyRenderTarget(target);
+    }
+    if (tiled.query) {
+        glDeleteQueries(1, &tiled.query);
+    }
+    tiled.query = 0;
+    tiled.hasCompleteImage = false;
+    tiled.passComplete = true;
+}
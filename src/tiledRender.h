@@ -0,0 +1,42 @@
+#pragma once
+
+#include "renderTarget.h"
+
+#include <functional>
+
+// the watchdog doesn't shrink the tiles below this size
+const int MinTileSize = 16;
+
+// heavy shaders are drawn in scissored tiles spread over several displayed frames, each frame submits the tiles
+// that fit in the time budget while the last complete image is displayed. Each tile is waited with a fence: a tile
+// slower than the timeout halves the tile size, at the minimum size the shader is stopped until it's reloaded
+struct TiledRender {
+    bool enabled = false;
+    float budgetMS = 10.0f;    // gpu time spent in tiles for each displayed frame
+    float timeoutMS = 2000.0f; // hard limit for one tile
+    int tileSize = 256;        // in pixels, shrunk by the watchdog
+
+    RenderTarget targets[2]; // pass in progress and last complete pass
+    int current = 0;         // index of the target drawn by the pass in progress
+    bool hasCompleteImage = false;
+    bool passComplete = true;
+    bool aborted = false;
+    int nextTile = 0;
+    int tileCount = 0;
+    float tileMS = 0.0f;        // last measured tile
+    float passMS = 0.0f;        // gpu time of the last complete pass
+    float currentPassMS = 0.0f; // gpu time spent in the pass in progress
+    GLuint query = 0;
+};
+
+// (re)create the framebuffers if needed, returns false if they can't be created
+bool setupTiledRender(TiledRender& tiled, int width, int height);
+// restart with the current uniforms, the previous complete image stays displayed until the new pass ends
+void startTiledPass(TiledRender& tiled);
+// allow a stopped shader to run again, used when the shader is reloaded
+void resetTiledRender(TiledRender& tiled);
+// draw the next tiles of the pass in progress, returns true when the pass is complete
+bool renderTiles(TiledRender& tiled, const std::function<void()>& draw);
+// last complete image, or the pass in progress if there is none yet
+GLuint getTiledRenderTexture(const TiledRender& tiled);
+void cleanupTiledRender(TiledRender& tiled);
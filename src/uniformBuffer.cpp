@@ -0,0 +1,99 @@
+#include "uniformBuffer.h"
+
+#include <stddef.h>
+#include <string.h>
+
+namespace {
+
+struct Field {
+    size_t offset;
+    size_t size;
+};
+
+// indexed by BuiltinUniform
+const Field Fields[BUILTIN_UNIFORM_COUNT] = {
+    {offsetof(UniformBlock, iMouse), sizeof(UniformBlock::iMouse)},
+    {offsetof(UniformBlock, iResolution), sizeof(UniformBlock::iResolution)},
+    {offsetof(UniformBlock, iTime), sizeof(UniformBlock::iTime)},
+    {offsetof(UniformBlock, iTimeDelta), sizeof(UniformBlock::iTimeDelta)},
+    {offsetof(UniformBlock, iFrame), sizeof(UniformBlock::iFrame)},
+    {offsetof(UniformBlock, iFrameRate), sizeof(UniformBlock::iFrameRate)},
+    {offsetof(UniformBlock, iSampleCount), sizeof(UniformBlock::iSampleCount)},
+    {offsetof(UniformBlock, iChannelResolution), sizeof(UniformBlock::iChannelResolution)},
+};
+
+static_assert(sizeof(UniformBlock) == 112, "UniformBlock does not match the std140 layout of ShaderJoyInputs");
+
+} // namespace
+
+bool initUniformBuffer(UniformBuffer& uniformBuffer)
+{
+    glGenBuffers(1, &uniformBuffer.buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer.buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(UniformBlock), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, UniformBlockBinding, uniformBuffer.buffer);
+    uniformBuffer.uploadedValid = false;
+    return glGetError() == GL_NO_ERROR;
+}
+
+void updateUniformBuffer(UniformBuffer& uniformBuffer, const UniformList& uniforms)
+{
+    UniformBlock block = {};
+    memcpy(block.iMouse, uniforms.iMouse, sizeof(block.iMouse));
+    memcpy(block.iResolution, uniforms.iResolution, sizeof(block.iResolution));
+    block.iTime = uniforms.iTime;
+    block.iTimeDelta = uniforms.iTimeDelta;
+    block.iFrame = uniforms.iFrame;
+    block.iFrameRate = uniforms.iFrameRate;
+    block.iSampleCount = uniforms.iSampleCount;
+    for (int i = 0; i < 4; i++) {
+        memcpy(block.iChannelResolution[i], uniforms.iChannelResolution[i], sizeof(uniforms.iChannelResolution[i]));
+    }
+
+    const char* newData = reinterpret_cast<const char*>(&block);
+    char* uploadedData = reinterpret_cast<char*>(&uniformBuffer.uploaded);
+
+    // find the fields that changed and the range covering them
+    unsigned int dirtyFields = 0;
+    size_t begin = sizeof(UniformBlock);
+    size_t end = 0;
+    for (int i = 0; i < BUILTIN_UNIFORM_COUNT; i++) {
+        const Field& field = Fields[i];
+        if (uniformBuffer.uploadedValid &&
+            memcmp(newData + field.offset, uploadedData + field.offset, field.size) == 0) {
+            continue;
+        }
+        dirtyFields |= 1u << i;
+        begin = field.offset < begin ? field.offset : begin;
+        end = field.offset + field.size > end ? field.offset + field.size : end;
+    }
+
+    uniformBuffer.dirtyFields = dirtyFields;
+    uniformBuffer.uploadedSize = 0;
+    if (!dirtyFields) {
+        return;
+    }
+
+    // invalidating the range lets the driver avoid waiting for the draws still reading the previous content
+    const size_t size = end - begin;
+    glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer.buffer);
+    void* data = glMapBufferRange(GL_UNIFORM_BUFFER, GLintptr(begin), GLsizeiptr(size),
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    if (!data) {
+        return;
+    }
+    memcpy(data, newData + begin, size);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+
+    memcpy(uploadedData + begin, newData + begin, size);
+    uniformBuffer.uploadedValid = true;
+    uniformBuffer.uploadedSize = size;
+}
+
+void cleanupUniformBuffer(UniformBuffer& uniformBuffer)
+{
+    if (uniformBuffer.buffer) {
+        glDeleteBuffers(1, &uniformBuffer.buffer);
+    }
+    uniformBuffer = UniformBuffer();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "UniformList.h"
+#include <glad/glad.h>
+#include <stddef.h>
+
+// std140 layout of the ShaderJoyInputs uniform block declared in the fragment template
+struct UniformBlock {
+    float iMouse[4];
+    float iResolution[3];
+    float iTime;
+    float iTimeDelta;
+    int iFrame;
+    float iFrameRate;
+    int iSampleCount;
+    float iChannelResolution[4][4]; // vec3 array elements are aligned on vec4
+};
+
+const GLuint UniformBlockBinding = 0;
+
+struct UniformBuffer {
+    GLuint buffer = 0;
+    UniformBlock uploaded = {};   // content of the buffer, used to find the fields that changed
+    bool uploadedValid = false;   // false until the first upload
+    unsigned int dirtyFields = 0; // one bit per BuiltinUniform uploaded by the last update
+    size_t uploadedSize = 0;      // bytes uploaded by the last update
+};
+
+bool initUniformBuffer(UniformBuffer& uniformBuffer);
+// upload only the range of the fields that changed since the last update
+void updateUniformBuffer(UniformBuffer& uniformBuffer, const UniformList& uniforms);
+void cleanupUniformBuffer(UniformBuffer& uniformBuffer);
@@ -1,9 +1,10 @@
 #include "watcher.h"
 #include "Application.h"
+#include "textureFile.h"
 #include "timer.h"
 
-#include <stb/stb_image.h>
-
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <thread>
 
@@ -26,58 +27,141 @@ bool readShaderFile(WatchFile& watchFile)
     return true;
 }
 
-bool readTextureFile(WatchFile& watchFile)
+bool readTextureFile(WatchFile& watchFile, const std::string& cacheDirectory)
 {
     if (watchFile.texture.target == Texture::TEXTURE_2D) {
+        if (!readImageFile(watchFile.path.c_str(), cacheDirectory, watchFile.texture)) {
+            return false;
+        }
+    } else {
+        // raw volumes are not copied, the mapping is uploaded slice by slice and released after the upload. The size
+        // of the file gives the number of channels
+        Texture& texture = watchFile.texture;
+        unmapFile(texture.mapped);
+        texture.data.clear();
+        if (!mapFile(watchFile.path.c_str(), texture.mapped)) {
+            printf("cant map file %s\n", watchFile.path.c_str());
+            return false;
+        }
 
-        FILE* file = fopen(watchFile.path.c_str(), "rb");
-        if (!file) {
-            printf("cant open file %s\n", watchFile.path.c_str());
+        const size_t componentSize = getTextureComponentSize(texture.type);
+        const size_t texels = size_t(texture.size[0]) * size_t(texture.size[1]) * size_t(texture.size[2]);
+        const size_t channel = texels ? texture.mapped.size / (texels * componentSize) : 0;
+        if (channel < 1 || channel > 4 || texture.mapped.size != texels * componentSize * channel) {
+            printf("volume %s is %zu bytes, it should be %dx%dx%d texels of 1 to 4 components of %zu bytes\n",
+                   watchFile.path.c_str(), texture.mapped.size, texture.size[0], texture.size[1], texture.size[2],
+                   componentSize);
+            unmapFile(texture.mapped);
             return false;
         }
+        const Texture::Format formats[4] = {Texture::R, Texture::RG, Texture::RGB, Texture::RGBA};
+        texture.format = formats[channel - 1];
+
+        printf("read volume %s %dx%dx%d : %zu (%zu bytes)\n", watchFile.path.c_str(), texture.size[0],
+               texture.size[1], texture.size[2], channel, texture.mapped.size);
+    }
+    return true;
+}
 
-#if 1
-        int channel = 0;
-        stbi_set_flip_vertically_on_load(true);
-        auto data = stbi_load_from_file(file, &watchFile.texture.size[0], &watchFile.texture.size[1], &channel, 0);
-        const size_t size = size_t(watchFile.texture.size[0]) * size_t(watchFile.texture.size[1]) * size_t(channel);
-        watchFile.texture.data.resize(size_t(size));
-        memcpy(watchFile.texture.data.data(), data, size);
-        stbi_image_free(data);
-        fclose(file);
-#else
-        static uint8_t textureData[4] = {255, 0, 255, 255};
-        const int channel = 4;
-        watchFile.texture.data.resize(4);
-        memcpy(watchFile.texture.data.data(), textureData, 4);
-        watchFile.texture.size[0] = 1;
-        watchFile.texture.size[1] = 1;
-#endif
-
-        printf("read image %s %dx%d : %d (%zu bytes)\n", watchFile.path.c_str(), watchFile.texture.size[0],
-               watchFile.texture.size[1], channel, watchFile.texture.data.size());
-        switch (channel) {
-        case 1:
-            watchFile.texture.format = Texture::R;
-            break;
-        case 2:
-            printf("images with format greysacle/alpha (2 channels)  are not supported");
+void releaseTextureData(Texture& texture)
+{
+    std::vector<uint8_t>().swap(texture.data);
+    texture.levels.clear();
+    unmapFile(texture.mapped);
+}
+
+bool parseTextureBlock(const char** argv, int i, Texture& texture)
+{
+    // --texture0 [2d:linear:repeat:precision:maxsize=N] filename, precision is f16 (default) or f32 for float images,
+    // images larger than maxsize are downscaled. Both are optional and in any order
+    // --texture0 [3d:linear:repeat:sizex:sizey:sizez:type] filename, type is u8 (default), u16, f16 or f32
+    const int MaxTokens = 8;
+    char tokens[MaxTokens][32];
+    int tokenCount = 0;
+    const char* text = argv[i];
+    const char* end = strchr(text, ']');
+    if (text[0] != '[' || !end || end[1]) {
+        printf("malformed texture description '%s', it should look like [2d:linear:repeat]\n", text);
+        return false;
+    }
+    for (const char* token = text + 1; token <= end && tokenCount < MaxTokens; tokenCount++) {
+        const char* tokenEnd = token + strcspn(token, ":]");
+        const size_t size = size_t(tokenEnd - token);
+        if (size >= sizeof(tokens[0])) {
+            printf("malformed texture description '%s', '%.*s' is too long\n", text, int(size), token);
             return false;
-            break;
-        case 3:
-            watchFile.texture.format = Texture::RGB;
-            break;
-        case 4:
-            watchFile.texture.format = Texture::RGBA;
-            break;
         }
-        watchFile.texture.type = Texture::UNSIGNED_BYTE;
+        memcpy(tokens[tokenCount], token, size);
+        tokens[tokenCount][size] = 0;
+        token = tokenEnd + 1;
+    }
 
+    bool success = tokenCount >= 3;
+    if (success && strcmp(tokens[0], "2d") == 0) {
+        texture.target = Texture::TEXTURE_2D;
+        texture.fullPrecision = false;
+        texture.maxSize = 0;
+        for (int token = 3; token < tokenCount && success; token++) {
+            if (strcmp(tokens[token], "f32") == 0 || strcmp(tokens[token], "f16") == 0) {
+                texture.fullPrecision = strcmp(tokens[token], "f32") == 0;
+            } else if (strncmp(tokens[token], "maxsize=", 8) == 0) {
+                texture.maxSize = atoi(tokens[token] + 8);
+                success = texture.maxSize > 0;
+            } else {
+                success = false;
+            }
+        }
+    } else if (success && strcmp(tokens[0], "3d") == 0) {
+        texture.target = Texture::TEXTURE_3D;
+        success = tokenCount == 6 || tokenCount == 7;
     } else {
-        printf("texture 3d not supported yet\n");
-        return false;
+        success = false;
     }
-    return true;
+
+    if (success && strcmp(tokens[1], "linear") == 0) {
+        texture.filter = Texture::LINEAR;
+    } else if (success && strcmp(tokens[1], "nearest") == 0) {
+        texture.filter = Texture::NEAREST;
+    } else if (success && strcmp(tokens[1], "linear_mipmap_linear") == 0) {
+        texture.filter = Texture::LINEAR_MIPMAP_LINEAR;
+    } else {
+        success = false;
+    }
+
+    if (success && strcmp(tokens[2], "repeat") == 0) {
+        texture.wrap = Texture::REPEAT;
+    } else if (success && strcmp(tokens[2], "clamp") == 0) {
+        texture.wrap = Texture::CLAMP;
+    } else {
+        success = false;
+    }
+
+    // if it's a 3d texture we need to parse the size and the type of the components
+    if (success && texture.target == Texture::TEXTURE_3D) {
+        for (int axis = 0; axis < 3; axis++) {
+            texture.size[axis] = atoi(tokens[3 + axis]);
+            success = success && texture.size[axis] > 0;
+        }
+        texture.type = Texture::UNSIGNED_BYTE;
+        if (tokenCount == 7) {
+            if (strcmp(tokens[6], "u16") == 0) {
+                texture.type = Texture::UNSIGNED_SHORT;
+            } else if (strcmp(tokens[6], "f16") == 0) {
+                texture.type = Texture::HALF_FLOAT;
+            } else if (strcmp(tokens[6], "f32") == 0) {
+                texture.type = Texture::FLOAT;
+            } else if (strcmp(tokens[6], "u8") != 0) {
+                success = false;
+            }
+        }
+    }
+
+    if (!success) {
+        printf("malformed texture description '%s', it should look like [2d:linear:repeat:f16|f32:maxsize=N] or "
+               "[3d:linear:repeat:sizex:sizey:sizez:u8|u16|f16|f32]\n",
+               text);
+    }
+    return success;
 }
 
 void fileWatcherThread(Application* application)
@@ -108,16 +192,21 @@ void fileWatcherThread(Application* application)
                     case WatchFile::TEXTURE1:
                     case WatchFile::TEXTURE2:
                     case WatchFile::TEXTURE3:
-                        success = readTextureFile(watchFile);
+                        success = readTextureFile(watchFile, application->textureCacheDirectory);
                         break;
                     }
                     if (success) {
                         watcher._fileChanged = int(i);
                     }
                     watcher.unlock();
+
+                    // the render loop can be blocked waiting for events
+                    if (success) {
+                        wakeInput(application->input);
+                    }
                 }
             }
         }
-        sleepInMS(500);
+        sleepInMS(100);
     }
 }
@@ -50,5 +50,13 @@ struct Watcher {
     }
 };
 
+// parse a texture description like [2d:linear:repeat] or [3d:linear:repeat:sizex:sizey:sizez:type] found in argv[i]
+bool parseTextureBlock(const char** argv, int i, Texture& texture);
+// load the file of the entry, used by the watcher thread
+bool readShaderFile(WatchFile& watchFile);
+bool readTextureFile(WatchFile& watchFile, const std::string& cacheDirectory);
+// free the pixels or unmap the volume or the cache file once the texture is uploaded
+void releaseTextureData(Texture& texture);
+
 struct Application;
 void fileWatcherThread(Application*);
@@ -1,6 +1,7 @@
 #include "window.h"
 #include "Application.h"
 #include "glad/glad.h"
+#include "timer.h"
 
 #include <GLFW/glfw3.h>
 #include <stdio.h>
@@ -8,6 +9,31 @@
 namespace {
 const char* const Title = "shaderjoy - Press space to pause";
 Application* gApplication = nullptr;
+// the title is changed from the main thread, the pause itself is toggled by the render thread
+bool gPausedTitle = false;
+
+void pushWindowInput(InputEvent::Type type, float x, float y, int key = 0, int action = 0, int mods = 0)
+{
+    InputEvent event;
+    event.type = type;
+    event.x = x;
+    event.y = y;
+    event.key = key;
+    event.action = action;
+    event.mods = mods;
+    event.time = getTimeInMS();
+    pushInput(gApplication->input, event);
+}
+
+void applyCursor(Application* app, const InputEvent& event)
+{
+    app->cursor[0] = event.x;
+    app->cursor[1] = event.y;
+    app->latency.inputTime = event.time;
+    if (app->region.selecting) {
+        updateRegionSelection(app->region, event.x, event.y);
+    }
+}
 } // namespace
 
 void setViewport(int width, int height)
@@ -60,8 +86,18 @@ GLFWwindow* setupWindow(WindowStyle style, Application* app)
     else if (style == ALLWAYS_ON_TOP)
         glfwWindowHint(GLFW_FLOATING, GL_TRUE);
 
-    if (style == FULLSCREEN) {
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    int monitorCount = 0;
+    GLFWmonitor** monitors = style == FULLSCREEN ? glfwGetMonitors(&monitorCount) : nullptr;
+    if (style == FULLSCREEN && !monitorCount) {
+        printf("no monitor found, fullscreen disabled\n");
+    } else if (style == FULLSCREEN) {
+        if (app->monitor < 0 || app->monitor >= monitorCount) {
+            printf("monitor %d not found, %d monitors available, use the primary monitor\n", app->monitor,
+                   monitorCount);
+            app->monitor = 0;
+        }
+        GLFWmonitor* monitor = monitors[app->monitor];
+        printf("fullscreen on monitor %d %s\n", app->monitor, glfwGetMonitorName(monitor));
         const GLFWvidmode* mode = glfwGetVideoMode(monitor);
         app->width = mode->width;
         app->height = mode->height;
@@ -70,7 +106,8 @@ GLFWwindow* setupWindow(WindowStyle style, Application* app)
         glfwWindowHint(GLFW_BLUE_BITS, mode->blueBits);
         glfwWindowHint(GLFW_REFRESH_RATE, mode->refreshRate);
         window = glfwCreateWindow(app->width, app->height, Title, monitor, NULL);
-    } else {
+    }
+    if (!monitorCount) {
         window = glfwCreateWindow(app->width, app->height, Title, NULL, NULL);
     }
 
@@ -91,37 +128,57 @@ GLFWwindow* setupWindow(WindowStyle style, Application* app)
     printf("%s\n", glGetString(GL_RENDERER));
     printf("Shading language : %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
 
+    // callbacks run on the main thread, they only queue the events for the render thread, see applyInput
     glfwSetWindowSizeCallback(window, [](GLFWwindow* window, int w, int h) {
         (void)window;
-        setViewport(w, h);
+        pushWindowInput(InputEvent::RESIZE, float(w), float(h));
     });
 
     glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int scancode, int action, int mods) {
-        (void)window;
         (void)scancode;
-        (void)action;
-        (void)mods;
         if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, GLFW_TRUE);
         } else if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) {
-            gApplication->pause = !gApplication->pause;
-            if (gApplication->pause) {
+            gPausedTitle = !gPausedTitle;
+            if (gPausedTitle) {
                 glfwSetWindowTitle(window, "shaderjoy - PAUSED");
             } else {
                 glfwSetWindowTitle(window, Title);
             }
         }
+        pushWindowInput(InputEvent::KEY, 0.0f, 0.0f, key, action, mods);
+    });
+
+    glfwSetCharCallback(window, [](GLFWwindow* window, unsigned int codepoint) {
+        (void)window;
+        pushWindowInput(InputEvent::CHAR, 0.0f, 0.0f, int(codepoint));
     });
 
+    // the cursor moves are coalesced, the button carries the position it was clicked at
     glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, int mods) {
+        double x, y;
+        glfwGetCursorPos(window, &x, &y);
+        pushWindowInput(InputEvent::MOUSE_BUTTON, float(x), float(y), button, action, mods);
+    });
+
+    glfwSetCursorPosCallback(window, [](GLFWwindow* window, double x, double y) {
         (void)window;
-        (void)mods;
-        // we dont care about all buttons. We handle only button 0 and 1
-        if (button > 1) {
-            return;
-        }
+        pushWindowInput(InputEvent::CURSOR, float(x), float(y));
+    });
+
+    glfwSetScrollCallback(window, [](GLFWwindow* window, double x, double y) {
+        (void)window;
+        pushWindowInput(InputEvent::SCROLL, float(x), float(y));
+    });
+
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* window, int focused) {
+        (void)window;
+        pushWindowInput(InputEvent::FOCUS, 0.0f, 0.0f, focused);
+    });
 
-        gApplication->mouseButtonClicked[button] = action == GLFW_PRESS;
+    glfwSetWindowIconifyCallback(window, [](GLFWwindow* window, int iconified) {
+        (void)window;
+        pushWindowInput(InputEvent::ICONIFY, 0.0f, 0.0f, iconified);
     });
 
     app->pixelRatio = getPixelRatio(window);
@@ -132,7 +189,13 @@ GLFWwindow* setupWindow(WindowStyle style, Application* app)
     }
     printf("window size %d x %d : pixel ratio %f\n", app->width, app->height, app->pixelRatio);
 
-    glfwSwapInterval(1);
+    // adaptive vsync tears instead of waiting a full refresh when a frame is late
+    if (app->swapInterval < 0 && !glfwExtensionSupported("WGL_EXT_swap_control_tear") &&
+        !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+        printf("adaptive vsync not supported, use a swap interval of 1\n");
+        app->swapInterval = 1;
+    }
+    glfwSwapInterval(app->swapInterval);
 
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -143,6 +206,58 @@ GLFWwindow* setupWindow(WindowStyle style, Application* app)
     return window;
 }
 
+void applyInput(Application* app, const InputEvent& event)
+{
+    switch (event.type) {
+    case InputEvent::RESIZE:
+        setViewport(int(event.x), int(event.y));
+        clearRegionOfInterest(app->region);
+        break;
+    case InputEvent::CURSOR:
+        applyCursor(app, event);
+        break;
+    case InputEvent::MOUSE_BUTTON:
+        applyCursor(app, event);
+        // shift + left drag selects the region of interest, the shader does not see this click
+        if (event.key == GLFW_MOUSE_BUTTON_LEFT && event.action == GLFW_PRESS && (event.mods & GLFW_MOD_SHIFT)) {
+            beginRegionSelection(app->region, app->cursor[0], app->cursor[1]);
+        } else if (event.key == GLFW_MOUSE_BUTTON_LEFT && event.action == GLFW_RELEASE && app->region.selecting) {
+            endRegionSelection(app->region, app->pixelRatio, int(float(app->width) * app->pixelRatio),
+                               int(float(app->height) * app->pixelRatio));
+            app->requestFrame = true;
+        } else if (event.key <= 1) {
+            // we dont care about all buttons. We handle only button 0 and 1
+            app->mouseButtonClicked[event.key] = event.action == GLFW_PRESS;
+        }
+        break;
+    case InputEvent::KEY:
+        if (event.key == GLFW_KEY_SPACE && event.action == GLFW_PRESS) {
+            app->pause = !app->pause;
+            app->requestFrame = true;
+        } else if (event.key == GLFW_KEY_C && event.action == GLFW_PRESS) {
+            app->checkerboard.enabled = !app->checkerboard.enabled;
+        } else if (event.key == GLFW_KEY_R && event.action == GLFW_PRESS) {
+            clearRegionOfInterest(app->region);
+            app->requestFrame = true;
+        } else if (event.key == GLFW_KEY_M && event.action == GLFW_PRESS && app->region.active) {
+            app->region.magnify = !app->region.magnify;
+            app->requestFrame = true;
+        }
+        break;
+    case InputEvent::FOCUS:
+        app->background.focused = event.key != 0;
+        app->requestFrame = true;
+        break;
+    case InputEvent::ICONIFY:
+        app->background.iconified = event.key != 0;
+        app->requestFrame = true;
+        break;
+    case InputEvent::SCROLL:
+    case InputEvent::CHAR:
+        break;
+    }
+}
+
 void cleanupWindow(GLFWwindow* window)
 {
     glfwDestroyWindow(window);
@@ -3,6 +3,10 @@
 struct GLFWwindow;
 enum WindowStyle { HEADLESS = 0, REGULAR, ALLWAYS_ON_TOP, FULLSCREEN };
 struct Application;
+struct InputEvent;
 
+// create the window and its context, current on the calling thread
 GLFWwindow* setupWindow(WindowStyle style, Application* app);
+// update the application from an event queued by the window callbacks, called by the thread owning the context
+void applyInput(Application* app, const InputEvent& event);
 void cleanupWindow(GLFWwindow* window);